@@ -0,0 +1,97 @@
+#include "BatchAnalysis.h"
+#include <chrono>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <memory>
+#include <string>
+
+// Command line batch analysis, reads one FEN or EPD position per line and writes the number of legal moves
+// or the legal moves of every position in input order, see BatchAnalysis.h for the output formats.
+// Results go to stdout as text, or to output_file in binary. Positions per second are printed to stderr.
+//
+// usage: ./batch <file|-> [count|moves] [threads] [output_file]
+// example: ./batch positions.epd moves 8 > moves.txt
+
+void print_usage() {
+    std::cerr << "usage: batch <file|-> [count|moves] [threads] [output_file]" << std::endl;
+    std::cerr << "  file         one FEN or EPD per line, - reads stdin" << std::endl;
+    std::cerr << "  count|moves  number of legal moves or the legal moves, count by default" << std::endl;
+    std::cerr << "  threads      number of threads, 1 by default" << std::endl;
+    std::cerr << "  output_file  write binary results there instead of text to stdout" << std::endl;
+}
+
+int main(int argc, char *argv[]) {
+    if (argc < 2 || argc > 5) {
+        print_usage();
+        return 1;
+    }
+
+    BatchAnalysis::Options options;
+    if (argc > 2) {
+        std::string mode = argv[2];
+        if (mode == "count") {
+            options.mode = BatchAnalysis::Mode::Count;
+        } else if (mode == "moves") {
+            options.mode = BatchAnalysis::Mode::Moves;
+        } else {
+            print_usage();
+            return 1;
+        }
+    }
+
+    try {
+        if (argc > 3) {
+            options.threads = std::stoi(argv[3]);
+        }
+    } catch (std::exception &e) {
+        print_usage();
+        return 1;
+    }
+    if (options.threads < 1) {
+        print_usage();
+        return 1;
+    }
+
+    std::ofstream output_file;
+    if (argc > 4) {
+        output_file.open(argv[4], std::ios::binary);
+        if (!output_file) {
+            std::cerr << "Can not open " << argv[4] << std::endl;
+            return 1;
+        }
+        options.format = BatchAnalysis::Format::Binary;
+    }
+    std::ostream &out = argc > 4 ? output_file : std::cout;
+    std::ios::sync_with_stdio(false);
+
+    // stdin can not be mapped, it is read into memory
+    std::string path = argv[1];
+    std::unique_ptr<MappedFile> file;
+    std::string stdin_input;
+    std::string_view input;
+    try {
+        if (path == "-") {
+            stdin_input.assign(std::istreambuf_iterator<char>(std::cin), std::istreambuf_iterator<char>());
+            input = stdin_input;
+        } else {
+            file = std::make_unique<MappedFile>(path);
+            input = file->view();
+        }
+    } catch (std::exception &e) {
+        std::cerr << e.what() << std::endl;
+        return 1;
+    }
+
+    auto start = std::chrono::steady_clock::now();
+    size_t positions = BatchAnalysis::run(input, out, options);
+    out.flush();
+    auto end = std::chrono::steady_clock::now();
+
+    double seconds = std::chrono::duration<double>(end - start).count();
+    std::cerr << "Positions: " << positions << std::endl;
+    std::cerr << "Time: " << (u_long64_t)(seconds * 1000) << " ms" << std::endl;
+    std::cerr << "Positions/s: " << (u_long64_t)(seconds > 0 ? positions / seconds : 0) << std::endl;
+
+    return 0;
+}
@@ -0,0 +1,209 @@
+#include "../include/GameState.h"
+#include "../include/ChessConstants.h"
+#include "../include/FenParser.h"
+#include <benchmark/benchmark.h>
+#include <string>
+#include <vector>
+
+// Micro benchmarks of the hot paths on a fixed set of positions: legal move generation per GenType,
+// count_legal_moves, the slider backends, attack checks, make/undo, copy-make and checked make_move, FEN and move parsing.
+// Select benchmarks with --benchmark_filter=<regex>, run with --benchmark_format=json
+// (or --benchmark_out=results.json --benchmark_out_format=json) to get results that can be compared between releases.
+
+struct BenchmarkPosition {
+    const char *name;
+    const char *fen;
+};
+
+const BenchmarkPosition POSITIONS[] = {
+    {"opening", STARTING_FEN},
+    {"middlegame", "r3k2r/p1ppqpb1/bn2pnp1/3PN3/1p2P3/2N2Q1p/PPPBBPPP/R3K2R w KQkq - 0 1"},
+    {"endgame", "8/2p5/3p4/KP5r/1R3p1k/8/4P1P1/8 w - - 0 1"},
+    {"promotions", "n1n5/PPPk4/8/8/8/8/4Kppp/5N1N b - - 0 1"},
+};
+const int POSITION_COUNT = sizeof(POSITIONS) / sizeof(POSITIONS[0]);
+
+GameState position_for(benchmark::State &state) {
+    const BenchmarkPosition &position = POSITIONS[state.range(0)];
+    state.SetLabel(position.name);
+    return FenParser::parse_fen(position.fen);
+}
+
+const GenType GEN_TYPES[] = {GenType::All, GenType::Tactical, GenType::Quiet, GenType::Captures};
+const char *const GEN_TYPE_NAMES[] = {"all", "tactical", "quiet", "captures"};
+const int GEN_TYPE_COUNT = sizeof(GEN_TYPES) / sizeof(GEN_TYPES[0]);
+
+// legal moves of one GenType, the second argument indexes GEN_TYPES
+void BM_GenerateLegalMoves(benchmark::State &state) {
+    GameState game = position_for(state);
+    GenType type = GEN_TYPES[state.range(1)];
+    state.SetLabel(std::string(POSITIONS[state.range(0)].name) + "/" + GEN_TYPE_NAMES[state.range(1)]);
+    for (auto _ : state) {
+        MoveList moves;
+        game.generate_legal_moves(game.turn, moves, type);
+        benchmark::DoNotOptimize(moves);
+    }
+}
+BENCHMARK(BM_GenerateLegalMoves)->ArgsProduct({
+    benchmark::CreateDenseRange(0, POSITION_COUNT - 1, 1),
+    benchmark::CreateDenseRange(0, GEN_TYPE_COUNT - 1, 1)
+});
+
+// counting without building the list, as perft does at its last ply
+void BM_CountLegalMoves(benchmark::State &state) {
+    GameState game = position_for(state);
+    // the Position version, GameState returns the size of its cached list once it has one
+    const Position &position = game.position();
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(position.count_legal_moves());
+    }
+}
+BENCHMARK(BM_CountLegalMoves)->DenseRange(0, POSITION_COUNT - 1);
+
+const Attacks::SliderBackend SLIDER_BACKENDS[] = {Attacks::SliderBackend::Magic, Attacks::SliderBackend::Pext};
+const char *const SLIDER_BACKEND_NAMES[] = {"magic", "pext"};
+
+// generate, copy-make and count the replies of every move, once per slider backend (second argument)
+void BM_SliderBackend(benchmark::State &state) {
+    GameState game = position_for(state);
+    const Position &position = game.position();
+    state.SetLabel(std::string(POSITIONS[state.range(0)].name) + "/" + SLIDER_BACKEND_NAMES[state.range(1)]);
+    Attacks::SliderBackend startup_backend = Position::get_slider_backend();
+    if (!Position::set_slider_backend(SLIDER_BACKENDS[state.range(1)])) {
+        state.SkipWithError("slider backend not supported by this CPU");
+        return;
+    }
+    Position child;
+    for (auto _ : state) {
+        MoveList moves;
+        position.generate_legal_moves(position.turn, moves);
+        int count = 0;
+        for (PackedMove move : moves) {
+            position.make_move(move, child);
+            count += child.count_legal_moves();
+        }
+        benchmark::DoNotOptimize(count);
+    }
+    Position::set_slider_backend(startup_backend);
+}
+BENCHMARK(BM_SliderBackend)->ArgsProduct({
+    benchmark::CreateDenseRange(0, POSITION_COUNT - 1, 1),
+    {0, 1}
+});
+
+// every square of the board checked once
+void BM_IsSquareAttacked(benchmark::State &state) {
+    GameState game = position_for(state);
+    for (auto _ : state) {
+        int attacked = 0;
+        for (int square = 0; square < 64; square++) {
+            attacked += game.is_square_attacked(square, game.turn);
+        }
+        benchmark::DoNotOptimize(attacked);
+    }
+    state.SetItemsProcessed(state.iterations() * 64);
+}
+BENCHMARK(BM_IsSquareAttacked)->DenseRange(0, POSITION_COUNT - 1);
+
+// make and undo every legal move of the position
+void BM_MakeUndoMove(benchmark::State &state) {
+    GameState game = position_for(state);
+    MoveList moves = game.get_legal_move_list();
+    for (auto _ : state) {
+        for (PackedMove move : moves) {
+            game.make_move_unchecked(move);
+            game.undo_move();
+        }
+    }
+    state.SetItemsProcessed(state.iterations() * moves.size());
+}
+BENCHMARK(BM_MakeUndoMove)->DenseRange(0, POSITION_COUNT - 1);
+
+// copy-make of every legal move of the position into a child Position
+void BM_CopyMakeMove(benchmark::State &state) {
+    GameState game = position_for(state);
+    MoveList moves = game.get_legal_move_list();
+    Position child;
+    for (auto _ : state) {
+        for (PackedMove move : moves) {
+            game.make_move(move, child);
+            benchmark::DoNotOptimize(child);
+        }
+    }
+    state.SetItemsProcessed(state.iterations() * moves.size());
+}
+BENCHMARK(BM_CopyMakeMove)->DenseRange(0, POSITION_COUNT - 1);
+
+// make_move checking legality and undo, every make generates and indexes the legal moves again
+void BM_MakeMoveChecked(benchmark::State &state) {
+    GameState game = position_for(state);
+    std::vector<Move> moves = game.get_legal_moves();
+    for (auto _ : state) {
+        for (const Move &move : moves) {
+            game.make_move(move);
+            game.undo_move();
+        }
+    }
+    state.SetItemsProcessed(state.iterations() * moves.size());
+}
+BENCHMARK(BM_MakeMoveChecked)->DenseRange(0, POSITION_COUNT - 1);
+
+void BM_ParseFen(benchmark::State &state) {
+    const BenchmarkPosition &position = POSITIONS[state.range(0)];
+    state.SetLabel(position.name);
+    std::string fen = position.fen;
+    for (auto _ : state) {
+        GameState game = FenParser::parse_fen(fen);
+        benchmark::DoNotOptimize(game);
+    }
+}
+BENCHMARK(BM_ParseFen)->DenseRange(0, POSITION_COUNT - 1);
+
+// the allocation free parser reusing one GameState, as the batch tool does
+void BM_ParseFenInPlace(benchmark::State &state) {
+    const BenchmarkPosition &position = POSITIONS[state.range(0)];
+    state.SetLabel(position.name);
+    std::string_view fen = position.fen;
+    GameState game;
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(FenParser::parse_fen(fen, game));
+        benchmark::ClobberMemory();
+    }
+}
+BENCHMARK(BM_ParseFenInPlace)->DenseRange(0, POSITION_COUNT - 1);
+
+void BM_ToFen(benchmark::State &state) {
+    const BenchmarkPosition &position = POSITIONS[state.range(0)];
+    state.SetLabel(position.name);
+    GameState game = FenParser::parse_fen(position.fen);
+    char fen[Position::MAX_FEN_LENGTH + 1];
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(game.to_fen(fen, sizeof(fen)));
+        benchmark::ClobberMemory();
+    }
+}
+BENCHMARK(BM_ToFen)->DenseRange(0, POSITION_COUNT - 1);
+
+void BM_ParseLan(benchmark::State &state) {
+    const std::vector<std::string> moves = {"e2-e4", "Nc3xd5", "e7-e8=Q", "O-O", "O-O-O", "e5xd6 e.p", "Qd1-h5", "Kg1-h1"};
+    for (auto _ : state) {
+        for (const std::string &move : moves) {
+            benchmark::DoNotOptimize(Move::parse_lan(move));
+        }
+    }
+    state.SetItemsProcessed(state.iterations() * moves.size());
+}
+BENCHMARK(BM_ParseLan);
+
+// validating a client move: parse, look it up in the legal moves and make it
+void BM_MakeMoveUci(benchmark::State &state) {
+    GameState game = FenParser::parse_fen(POSITIONS[1].fen);
+    std::string move = "e1g1";
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(game.make_move_uci(move));
+        game.undo_move();
+    }
+}
+BENCHMARK(BM_MakeMoveUci);
+
+BENCHMARK_MAIN();
@@ -0,0 +1,260 @@
+#include "ChessConstants.h"
+#include "Bitboard.h"
+#include <stdexcept>
+
+#pragma once
+
+/**
+ * @brief Attack tables of all pieces, computed at compile time.
+ *
+ * The tables are declared here and defined as constexpr in Attacks.cpp, so the compiler builds them once
+ * from the generator functions below, they are stored in read only data and ready before main starts.
+ * Only the magic numbers in ChessConstants.h are found outside of the build, by lookup_generator.
+ * A magic number that maps blocker sets with different attacks to the same entry stops the build,
+ * see generate_slider_table, so a wrong or stale magic can not give wrong attacks.
+ * Attacks.h wraps these tables in the lookup functions the move generator uses.
+ */
+namespace AttackTables {
+  // (rank, file) steps, rank 0 is the top of the board where the black pieces start
+  constexpr int ROOK_DIRECTIONS[4][2] = {{-1, 0}, {1, 0}, {0, -1}, {0, 1}};
+  constexpr int BISHOP_DIRECTIONS[4][2] = {{-1, -1}, {-1, 1}, {1, -1}, {1, 1}};
+  constexpr int KING_STEPS[8][2] = {{-1, -1}, {-1, 0}, {-1, 1}, {0, -1}, {0, 1}, {1, -1}, {1, 0}, {1, 1}};
+  constexpr int KNIGHT_STEPS[8][2] = {{-2, -1}, {-2, 1}, {-1, -2}, {-1, 2}, {1, -2}, {1, 2}, {2, -1}, {2, 1}};
+
+  constexpr u_long64_t RANK_8 = 0xFFULL;
+  constexpr u_long64_t RANK_1 = 0xFFULL << 56;
+  constexpr u_long64_t FILE_A = 0x0101010101010101ULL;
+  constexpr u_long64_t FILE_H = 0x8080808080808080ULL;
+
+  // sum of 2^popcount(mask) over all squares
+  constexpr int ROOK_TABLE_SIZE = 102400;
+  constexpr int BISHOP_TABLE_SIZE = 5248;
+
+  constexpr bool on_board(int rank, int file) {
+    return rank >= 0 && rank < 8 && file >= 0 && file < 8;
+  }
+
+  // walk the rays from a square in the given directions until the edge of the board or a blocker
+  constexpr u_long64_t ray_attacks(int square, u_long64_t occupancy, const int directions[][2], int direction_count = 4) {
+    u_long64_t attacks = 0;
+    for(int d = 0; d < direction_count; d++) {
+      int rank = square / 8 + directions[d][0];
+      int file = square % 8 + directions[d][1];
+      while(on_board(rank, file)) {
+        u_long64_t bb = Bitboard::square_bb(rank * 8 + file);
+        attacks |= bb;
+        if(occupancy & bb) {
+          break;
+        }
+        rank += directions[d][0];
+        file += directions[d][1];
+      }
+    }
+    return attacks;
+  }
+
+  constexpr u_long64_t rook_rays(int square, u_long64_t occupancy) {
+    return ray_attacks(square, occupancy, ROOK_DIRECTIONS);
+  }
+
+  constexpr u_long64_t bishop_rays(int square, u_long64_t occupancy) {
+    return ray_attacks(square, occupancy, BISHOP_DIRECTIONS);
+  }
+
+  // squares that can block a rook, the edges are removed unless the rook is standing on that edge,
+  // then only the corners are not needed
+  constexpr u_long64_t rook_mask(int square) {
+    u_long64_t edges = ((RANK_1 | RANK_8) & ~(RANK_8 << (8 * (square / 8))))
+      | ((FILE_A | FILE_H) & ~(FILE_A << (square % 8)));
+    return rook_rays(square, 0) & ~edges;
+  }
+
+  constexpr u_long64_t bishop_mask(int square) {
+    return bishop_rays(square, 0) & ~(RANK_1 | RANK_8 | FILE_A | FILE_H);
+  }
+
+  struct SquareTable {
+    u_long64_t squares[64];
+  };
+
+  // empty board rays of the rook directions followed by the bishop directions,
+  // indexed by direction (0-3 ROOK_DIRECTIONS, 4-7 BISHOP_DIRECTIONS) and square
+  struct RayTable {
+    u_long64_t rays[8][64];
+  };
+
+  constexpr RayTable generate_rays() {
+    RayTable table = {};
+    for(int square = 0; square < 64; square++) {
+      for(int d = 0; d < 4; d++) {
+        int rook_direction[1][2] = {{ROOK_DIRECTIONS[d][0], ROOK_DIRECTIONS[d][1]}};
+        int bishop_direction[1][2] = {{BISHOP_DIRECTIONS[d][0], BISHOP_DIRECTIONS[d][1]}};
+        table.rays[d][square] = ray_attacks(square, 0, rook_direction, 1);
+        table.rays[d + 4][square] = ray_attacks(square, 0, bishop_direction, 1);
+      }
+    }
+    return table;
+  }
+
+  // rays going to higher square indexes, the nearest blocker on them is the lowest set bit
+  constexpr bool is_positive_direction(int d) {
+    const int (*directions)[2] = d < 4 ? ROOK_DIRECTIONS : BISHOP_DIRECTIONS;
+    return directions[d % 4][0] * 8 + directions[d % 4][1] > 0;
+  }
+
+  // Attacks from the empty board rays: everything behind the nearest blocker of a ray is removed by xoring
+  // the ray of the blocker square in the same direction. Much cheaper than walking the rays square by square,
+  // which matters because the compiler runs it for every entry of the slider tables.
+  constexpr u_long64_t slider_attacks(const RayTable &table, int square, u_long64_t occupancy, int first_direction) {
+    u_long64_t attacks = 0;
+    for(int d = first_direction; d < first_direction + 4; d++) {
+      u_long64_t ray = table.rays[d][square];
+      u_long64_t blockers = ray & occupancy;
+      if(blockers) {
+        int blocker = is_positive_direction(d) ? __builtin_ctzll(blockers) : 63 - __builtin_clzll(blockers);
+        ray ^= table.rays[d][blocker];
+      }
+      attacks |= ray;
+    }
+    return attacks;
+  }
+
+  // attacks of a piece that makes single steps, the king or the knight
+  constexpr SquareTable generate_step_attacks(const int steps[8][2]) {
+    SquareTable table = {};
+    for(int square = 0; square < 64; square++) {
+      for(int s = 0; s < 8; s++) {
+        int rank = square / 8 + steps[s][0];
+        int file = square % 8 + steps[s][1];
+        if(on_board(rank, file)) {
+          table.squares[square] |= Bitboard::square_bb(rank * 8 + file);
+        }
+      }
+    }
+    return table;
+  }
+
+  struct PawnTable {
+    // indexed by Piece::colour_index of the pawn
+    u_long64_t squares[2][64];
+  };
+
+  constexpr PawnTable generate_pawn_attacks() {
+    PawnTable table = {};
+    for(int square = 0; square < 64; square++) {
+      // white pawns move up the board (towards square 0), black pawns down
+      for(int colour = 0; colour < 2; colour++) {
+        int rank = square / 8 + (colour == 0 ? -1 : 1);
+        for(int file = square % 8 - 1; file <= square % 8 + 1; file += 2) {
+          if(on_board(rank, file)) {
+            table.squares[colour][square] |= Bitboard::square_bb(rank * 8 + file);
+          }
+        }
+      }
+    }
+    return table;
+  }
+
+  struct SquarePairTable {
+    u_long64_t squares[64][64];
+  };
+
+  // squares strictly between two aligned squares, or the whole line through them when line is set
+  constexpr SquarePairTable generate_square_pairs(bool line) {
+    SquarePairTable table = {};
+    for(int square1 = 0; square1 < 64; square1++) {
+      for(int square2 = 0; square2 < 64; square2++) {
+        u_long64_t bb1 = Bitboard::square_bb(square1);
+        u_long64_t bb2 = Bitboard::square_bb(square2);
+        if(square1 == square2) {
+          continue;
+        }
+
+        const int (*directions)[2] = nullptr;
+        if(rook_rays(square1, 0) & bb2) {
+          directions = ROOK_DIRECTIONS;
+        } else if(bishop_rays(square1, 0) & bb2) {
+          directions = BISHOP_DIRECTIONS;
+        } else {
+          continue;
+        }
+
+        table.squares[square1][square2] = line
+          ? (ray_attacks(square1, 0, directions) & ray_attacks(square2, 0, directions)) | bb1 | bb2
+          : ray_attacks(square1, bb2, directions) & ray_attacks(square2, bb1, directions);
+      }
+    }
+    return table;
+  }
+
+  // everything needed to look up the attacks of a slider on one square, kept together so it is a single cache line
+  struct SliderMagic {
+    u_long64_t mask;
+    u_long64_t magic;
+    // start of the square's attacks in SliderTable::attacks and SliderTable::pext_attacks
+    int offset;
+    int shift;
+  };
+
+  constexpr int magic_index(const SliderMagic &entry, u_long64_t occupancy) {
+    return (int)(((occupancy & entry.mask) * entry.magic) >> entry.shift);
+  }
+
+  /**
+   * @brief Attacks of a slider for every blocker configuration of every square, indexed two ways.
+   *
+   * attacks is indexed by offset + magic_index, pext_attacks by offset + pext(occupancy, mask).
+  */
+  template<int SIZE>
+  struct SliderTable {
+    SliderMagic magics[64];
+    u_long64_t attacks[SIZE];
+    u_long64_t pext_attacks[SIZE];
+  };
+
+  // first_direction is 0 for rooks and 4 for bishops, see RayTable
+  template<int SIZE>
+  constexpr SliderTable<SIZE> generate_slider_table(const RayTable &rays, int first_direction,
+    const u_long64_t magic_numbers[64], u_long64_t (*mask)(int)) {
+    SliderTable<SIZE> table = {};
+    int offset = 0;
+    for(int square = 0; square < 64; square++) {
+      SliderMagic &entry = table.magics[square];
+      entry.mask = mask(square);
+      entry.magic = magic_numbers[square];
+      entry.shift = 64 - Bitboard::popcount(entry.mask);
+      entry.offset = offset;
+
+      // iterate over all subsets of the mask (carry rippler),
+      // the subsets come in the same order as pext indexes, so the n-th subset has pext index n
+      u_long64_t occupancy = 0;
+      int pext_index = 0;
+      do {
+        u_long64_t attacks = slider_attacks(rays, square, occupancy, first_direction);
+        // a slider always attacks at least one square, so a non zero entry was written by another subset,
+        // sharing it is only allowed when the attacks are the same. Throwing here is not a constant expression,
+        // so a bad magic number fails the build.
+        u_long64_t &magic_entry = table.attacks[offset + magic_index(entry, occupancy)];
+        if(magic_entry != 0 && magic_entry != attacks) {
+          throw std::logic_error("magic number maps blocker sets with different attacks to one entry");
+        }
+        magic_entry = attacks;
+        table.pext_attacks[offset + pext_index] = attacks;
+        occupancy = (occupancy - entry.mask) & entry.mask;
+        pext_index++;
+      } while(occupancy != 0);
+
+      offset += 1 << Bitboard::popcount(entry.mask);
+    }
+    return table;
+  }
+
+  extern const SquareTable knight;
+  extern const SquareTable king;
+  extern const PawnTable pawn;
+  extern const RayTable rays;
+  extern const SquarePairTable between;
+  extern const SquarePairTable line;
+  extern const SliderTable<ROOK_TABLE_SIZE> rook;
+  extern const SliderTable<BISHOP_TABLE_SIZE> bishop;
+};
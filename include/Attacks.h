@@ -0,0 +1,160 @@
+#include "ChessConstants.h"
+#include "Bitboard.h"
+#include "AttackTables.h"
+#include "../src/Piece.cpp"
+
+#pragma once
+
+/**
+ * @brief Attack lookups for all pieces, sliding pieces use magic bitboards.
+ *
+ * For every square we keep a mask of the squares that can block a slider (the rays without the board edge),
+ * a magic number and a table of attacks. The blockers are extracted from the occupancy with the mask,
+ * multiplied by the magic number and shifted, which gives a unique index into the attack table
+ * for every blocker configuration that matters.
+ *
+ * Magic numbers are found by lookup_generator and stored in ChessConstants.h,
+ * all attack tables are computed at compile time in AttackTables.h.
+ *
+ * On x86-64 CPUs with BMI2 the blockers can be packed into an index directly with the PEXT instruction.
+ * The slider lookups are templated on the backend, Position compiles its move generators once for each
+ * and picks the copy for the CPU at startup, see Position::get_slider_backend.
+ */
+
+// PEXT is only compiled on x86-64, other platforms always use magics
+#if defined(__x86_64__) && (defined(__GNUC__) || defined(__clang__))
+#define ATTACKS_HAS_PEXT 1
+#else
+#define ATTACKS_HAS_PEXT 0
+#endif
+
+#if ATTACKS_HAS_PEXT && defined(__BMI2__)
+#include <immintrin.h>
+#endif
+
+namespace Attacks {
+  // how rook and bishop attacks are indexed in their tables, a magic multiply and shift or PEXT
+  enum class SliderBackend {
+    Magic,
+    Pext
+  };
+
+  /**
+   * @brief Checks CPUID for the BMI2 instruction set, which has the PEXT instruction.
+  */
+  bool cpu_has_pext();
+
+  /**
+   * @brief Checks CPUID for a fast PEXT instruction.
+   * BMI2 has to be present and the CPU can't be an AMD Zen 1 or Zen 2, where PEXT is microcoded and slower than magics.
+  */
+  bool cpu_has_fast_pext();
+
+#if ATTACKS_HAS_PEXT
+  // the bits of occupancy selected by mask packed into the lowest bits, must only run on CPUs with BMI2
+  inline u_long64_t pext(u_long64_t occupancy, u_long64_t mask) {
+#if defined(__BMI2__)
+    return _pext_u64(occupancy, mask);
+#else
+    // the intrinsic needs target("bmi2") and could not be inlined into generic code, inline asm can
+    u_long64_t index;
+    asm("pextq %2, %1, %0" : "=r"(index) : "r"(occupancy), "rm"(mask));
+    return index;
+#endif
+  }
+#endif
+
+  /**
+   * @brief Squares attacked by a rook standing on a square, including the first blocker in every direction.
+   * The blocker can be of any colour, it's the callers responsibility to remove own pieces.
+   * The Pext backend must only be used when cpu_has_pext is true, without PEXT support it is the same as Magic.
+   *
+   * @param square The square of the rook.
+   * @param occupancy Bitboard of all pieces on the board.
+  */
+  template<SliderBackend B = SliderBackend::Magic>
+  inline u_long64_t rook_attacks(int square, u_long64_t occupancy) {
+    const AttackTables::SliderMagic &entry = AttackTables::rook.magics[square];
+#if ATTACKS_HAS_PEXT
+    if constexpr(B == SliderBackend::Pext) {
+      return AttackTables::rook.pext_attacks[entry.offset + pext(occupancy, entry.mask)];
+    }
+#endif
+    return AttackTables::rook.attacks[entry.offset + AttackTables::magic_index(entry, occupancy)];
+  }
+
+  // same as rook_attacks but for bishops
+  template<SliderBackend B = SliderBackend::Magic>
+  inline u_long64_t bishop_attacks(int square, u_long64_t occupancy) {
+    const AttackTables::SliderMagic &entry = AttackTables::bishop.magics[square];
+#if ATTACKS_HAS_PEXT
+    if constexpr(B == SliderBackend::Pext) {
+      return AttackTables::bishop.pext_attacks[entry.offset + pext(occupancy, entry.mask)];
+    }
+#endif
+    return AttackTables::bishop.attacks[entry.offset + AttackTables::magic_index(entry, occupancy)];
+  }
+
+  inline u_long64_t knight_attacks(int square) {
+    return AttackTables::knight.squares[square];
+  }
+
+  inline u_long64_t king_attacks(int square) {
+    return AttackTables::king.squares[square];
+  }
+
+  // squares attacked by a pawn of a given colour (Piece::White or Piece::Black) standing on a square
+  inline u_long64_t pawn_attacks(int color, int square) {
+    return AttackTables::pawn.squares[Piece::colour_index(color)][square];
+  }
+
+  // squares attacked by all pawns of a given colour at once
+  inline u_long64_t all_pawn_attacks(int color, u_long64_t pawns) {
+    const u_long64_t FILE_A = 0x0101010101010101ULL;
+    const u_long64_t FILE_H = 0x8080808080808080ULL;
+    if(color == Piece::White) {
+      return ((pawns & ~FILE_A) >> 9) | ((pawns & ~FILE_H) >> 7);
+    }
+    return ((pawns & ~FILE_A) << 7) | ((pawns & ~FILE_H) << 9);
+  }
+
+  template<SliderBackend B = SliderBackend::Magic>
+  inline u_long64_t queen_attacks(int square, u_long64_t occupancy) {
+    return rook_attacks<B>(square, occupancy) | bishop_attacks<B>(square, occupancy);
+  }
+
+  // squares strictly between two squares on the same rank, file or diagonal, empty if they are not aligned
+  inline u_long64_t between(int square1, int square2) {
+    return AttackTables::between.squares[square1][square2];
+  }
+
+  // the whole line (edge to edge) going through both squares, empty if they are not aligned
+  inline u_long64_t line(int square1, int square2) {
+    return AttackTables::line.squares[square1][square2];
+  }
+
+  // the empty board ray from a square to the edge in one direction, not including the square itself,
+  // directions 0-3 are AttackTables::ROOK_DIRECTIONS and 4-7 AttackTables::BISHOP_DIRECTIONS
+  inline u_long64_t ray(int direction, int square) {
+    return AttackTables::rays.rays[direction][square];
+  }
+
+  // squares that can block a rook or a bishop, the last square of every ray is not included
+  // because a piece standing there does not change the attacks
+  inline u_long64_t rook_mask(int square) {
+    return AttackTables::rook_mask(square);
+  }
+
+  inline u_long64_t bishop_mask(int square) {
+    return AttackTables::bishop_mask(square);
+  }
+
+  // slow attack generation by walking the rays square by square, the tables are built from it, also used by lookup_generator
+  inline u_long64_t reference_rook_attacks(int square, u_long64_t occupancy) {
+    return AttackTables::rook_rays(square, occupancy);
+  }
+
+  inline u_long64_t reference_bishop_attacks(int square, u_long64_t occupancy) {
+    return AttackTables::bishop_rays(square, occupancy);
+  }
+};
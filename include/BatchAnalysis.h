@@ -0,0 +1,84 @@
+#include "GameState.h"
+#include <cstddef>
+#include <ostream>
+#include <string>
+#include <string_view>
+
+#pragma once
+
+/**
+ * @brief A file mapped read only into memory, so its lines can be parsed in place without copying them.
+ * An empty file gives an empty view.
+ *
+ * \b Example: MappedFile file("positions.epd"); std::string_view text = file.view();
+ */
+class MappedFile {
+public:
+  /**
+   * @throws std::runtime_error if the file can not be opened or mapped.
+  */
+  explicit MappedFile(const std::string &path);
+  ~MappedFile();
+
+  MappedFile(const MappedFile &) = delete;
+  MappedFile &operator=(const MappedFile &) = delete;
+
+  std::string_view view() const { return std::string_view(data, size); }
+
+private:
+  const char *data = nullptr;
+  size_t size = 0;
+};
+
+/**
+ * @brief Legal move counts or legal move lists of many FEN or EPD positions, one position per line.
+ *
+ * The input is split into chunks of whole lines. Every chunk is parsed in place into a GameState that
+ * each worker reuses (FenParser::parse_fen(std::string_view, GameState&)), so no memory is allocated per position.
+ * Chunks run on a ThreadPool a window at a time and their output is written in input order.
+ * Empty lines are skipped, every other line gives exactly one result.
+ *
+ * Text output is one line per position: the number of legal moves, or the moves in coordinate notation
+ * (e2e4, e7e8q) separated by spaces, or "error: <reason>" when the line is not a valid position.
+ *
+ * Binary output, in the byte order of the machine:
+ * Count: an int32 per position, -1 for invalid lines.
+ * Moves: an uint16 number of moves (0xFFFF for invalid lines) followed by the moves as PackedMove data.
+ *
+ * \b Example: BatchAnalysis::Options options; options.threads = 8; BatchAnalysis::run(file.view(), std::cout, options);
+ */
+class BatchAnalysis {
+public:
+  enum class Mode {
+    Count,
+    Moves
+  };
+
+  enum class Format {
+    Text,
+    Binary
+  };
+
+  struct Options {
+    Mode mode = Mode::Count;
+    Format format = Format::Text;
+    int threads = 1;
+    // approximate size of a chunk of input given to one task
+    size_t chunk_bytes = 1 << 16;
+  };
+
+  /**
+   * @brief Analyse every position of the input and write the results to out in input order.
+   *
+   * @return Number of positions, invalid lines included.
+  */
+  static size_t run(std::string_view input, std::ostream &out, const Options &options);
+
+  /**
+   * @brief Analyse the positions of a piece of input made of whole lines, appending the results to out.
+   * game is only used as memory for the positions, its previous content does not matter.
+   *
+   * @return Number of positions.
+  */
+  static size_t analyse_chunk(std::string_view chunk, GameState &game, std::string &out, const Options &options);
+};
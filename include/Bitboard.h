@@ -0,0 +1,31 @@
+#include "ChessConstants.h"
+
+#pragma once
+
+// A bitboard is a 64 bit integer where bit i is set when square i is occupied,
+// squares are indexed the same way as GameState::board, so bit 0 is a8 and bit 63 is h1.
+namespace Bitboard {
+  constexpr u_long64_t square_bb(int square) {
+    return 1ULL << square;
+  }
+
+  constexpr bool is_set(u_long64_t bb, int square) {
+    return (bb & square_bb(square)) != 0;
+  }
+
+  constexpr int popcount(u_long64_t bb) {
+    return __builtin_popcountll(bb);
+  }
+
+  // index of the least significant set bit, bb cannot be empty
+  inline int lsb(u_long64_t bb) {
+    return __builtin_ctzll(bb);
+  }
+
+  // returns the least significant set bit and clears it
+  inline int pop_lsb(u_long64_t &bb) {
+    int square = lsb(bb);
+    bb &= bb - 1;
+    return square;
+  }
+};
@@ -1,3 +1,5 @@
+#pragma once
+
 #define DIR_UP -8  
 #define DIR_DOWN 8
 #define DIR_LEFT -1
@@ -19,206 +21,139 @@
 typedef unsigned long long int u_long64_t;
 
 namespace ChessConstants {
-  // these lookups are not yet used anywhere
- const u_long64_t knight_lookup[64] = {
-0b0000000000000000000000000000000000000000000000100000010000000000,
-0b0000000000000000000000000000000000000000000001010000100000000000,
-0b0000000000000000000000000000000000000000000010100001000100000000,
-0b0000000000000000000000000000000000000000000101000010001000000000,
-0b0000000000000000000000000000000000000000001010000100010000000000,
-0b0000000000000000000000000000000000000000010100001000100000000000,
-0b0000000000000000000000000000000000000000101000000001000000000000,
-0b0000000000000000000000000000000000000000010000000010000000000000,
-0b0000000000000000000000000000000000000010000001000000000000000100,
-0b0000000000000000000000000000000000000101000010000000000000001000,
-0b0000000000000000000000000000000000001010000100010000000000010001,
-0b0000000000000000000000000000000000010100001000100000000000100010,
-0b0000000000000000000000000000000000101000010001000000000001000100,
-0b0000000000000000000000000000000001010000100010000000000010001000,
-0b0000000000000000000000000000000010100000000100000000000000010000,
-0b0000000000000000000000000000000001000000001000000000000000100000,
-0b0000000000000000000000000000001000000100000000000000010000000010,
-0b0000000000000000000000000000010100001000000000000000100000000101,
-0b0000000000000000000000000000101000010001000000000001000100001010,
-0b0000000000000000000000000001010000100010000000000010001000010100,
-0b0000000000000000000000000010100001000100000000000100010000101000,
-0b0000000000000000000000000101000010001000000000001000100001010000,
-0b0000000000000000000000001010000000010000000000000001000010100000,
-0b0000000000000000000000000100000000100000000000000010000001000000,
-0b0000000000000000000000100000010000000000000001000000001000000000,
-0b0000000000000000000001010000100000000000000010000000010100000000,
-0b0000000000000000000010100001000100000000000100010000101000000000,
-0b0000000000000000000101000010001000000000001000100001010000000000,
-0b0000000000000000001010000100010000000000010001000010100000000000,
-0b0000000000000000010100001000100000000000100010000101000000000000,
-0b0000000000000000101000000001000000000000000100001010000000000000,
-0b0000000000000000010000000010000000000000001000000100000000000000,
-0b0000000000000010000001000000000000000100000000100000000000000000,
-0b0000000000000101000010000000000000001000000001010000000000000000,
-0b0000000000001010000100010000000000010001000010100000000000000000,
-0b0000000000010100001000100000000000100010000101000000000000000000,
-0b0000000000101000010001000000000001000100001010000000000000000000,
-0b0000000001010000100010000000000010001000010100000000000000000000,
-0b0000000010100000000100000000000000010000101000000000000000000000,
-0b0000000001000000001000000000000000100000010000000000000000000000,
-0b0000001000000100000000000000010000000010000000000000000000000000,
-0b0000010100001000000000000000100000000101000000000000000000000000,
-0b0000101000010001000000000001000100001010000000000000000000000000,
-0b0001010000100010000000000010001000010100000000000000000000000000,
-0b0010100001000100000000000100010000101000000000000000000000000000,
-0b0101000010001000000000001000100001010000000000000000000000000000,
-0b1010000000010000000000000001000010100000000000000000000000000000,
-0b0100000000100000000000000010000001000000000000000000000000000000,
-0b0000010000000000000001000000001000000000000000000000000000000000,
-0b0000100000000000000010000000010100000000000000000000000000000000,
-0b0001000100000000000100010000101000000000000000000000000000000000,
-0b0010001000000000001000100001010000000000000000000000000000000000,
-0b0100010000000000010001000010100000000000000000000000000000000000,
-0b1000100000000000100010000101000000000000000000000000000000000000,
-0b0001000000000000000100001010000000000000000000000000000000000000,
-0b0010000000000000001000000100000000000000000000000000000000000000,
-0b0000000000000100000000100000000000000000000000000000000000000000,
-0b0000000000001000000001010000000000000000000000000000000000000000,
-0b0000000000010001000010100000000000000000000000000000000000000000,
-0b0000000000100010000101000000000000000000000000000000000000000000,
-0b0000000001000100001010000000000000000000000000000000000000000000,
-0b0000000010001000010100000000000000000000000000000000000000000000,
-0b0000000000010000101000000000000000000000000000000000000000000000,
-0b0000000000100000010000000000000000000000000000000000000000000000,
-};
-
-const u_long64_t bishop_lookup[64] = {
-0b1000000001000000001000000001000000001000000001000000001000000000,
-0b0000000010000000010000000010000000010000000010000000010100000000,
-0b0000000000000000100000000100000000100000000100010000101000000000,
-0b0000000000000000000000001000000001000001001000100001010000000000,
-0b0000000000000000000000000000000110000010010001000010100000000000,
-0b0000000000000000000000010000001000000100100010000101000000000000,
-0b0000000000000001000000100000010000001000000100001010000000000000,
-0b0000000100000010000001000000100000010000001000000100000000000000,
-0b0100000000100000000100000000100000000100000000100000000000000010,
-0b1000000001000000001000000001000000001000000001010000000000000101,
-0b0000000010000000010000000010000000010001000010100000000000001010,
-0b0000000000000000100000000100000100100010000101000000000000010100,
-0b0000000000000000000000011000001001000100001010000000000000101000,
-0b0000000000000001000000100000010010001000010100000000000001010000,
-0b0000000100000010000001000000100000010000101000000000000010100000,
-0b0000001000000100000010000001000000100000010000000000000001000000,
-0b0010000000010000000010000000010000000010000000000000001000000100,
-0b0100000000100000000100000000100000000101000000000000010100001000,
-0b1000000001000000001000000001000100001010000000000000101000010001,
-0b0000000010000000010000010010001000010100000000000001010000100010,
-0b0000000000000001100000100100010000101000000000000010100001000100,
-0b0000000100000010000001001000100001010000000000000101000010001000,
-0b0000001000000100000010000001000010100000000000001010000000010000,
-0b0000010000001000000100000010000001000000000000000100000000100000,
-0b0001000000001000000001000000001000000000000000100000010000001000,
-0b0010000000010000000010000000010100000000000001010000100000010000,
-0b0100000000100000000100010000101000000000000010100001000100100000,
-0b1000000001000001001000100001010000000000000101000010001001000001,
-0b0000000110000010010001000010100000000000001010000100010010000010,
-0b0000001000000100100010000101000000000000010100001000100000000100,
-0b0000010000001000000100001010000000000000101000000001000000001000,
-0b0000100000010000001000000100000000000000010000000010000000010000,
-0b0000100000000100000000100000000000000010000001000000100000010000,
-0b0001000000001000000001010000000000000101000010000001000000100000,
-0b0010000000010001000010100000000000001010000100010010000001000000,
-0b0100000100100010000101000000000000010100001000100100000110000000,
-0b1000001001000100001010000000000000101000010001001000001000000001,
-0b0000010010001000010100000000000001010000100010000000010000000010,
-0b0000100000010000101000000000000010100000000100000000100000000100,
-0b0001000000100000010000000000000001000000001000000001000000001000,
-0b0000010000000010000000000000001000000100000010000001000000100000,
-0b0000100000000101000000000000010100001000000100000010000001000000,
-0b0001000100001010000000000000101000010001001000000100000010000000,
-0b0010001000010100000000000001010000100010010000011000000000000000,
-0b0100010000101000000000000010100001000100100000100000000100000000,
-0b1000100001010000000000000101000010001000000001000000001000000001,
-0b0001000010100000000000001010000000010000000010000000010000000010,
-0b0010000001000000000000000100000000100000000100000000100000000100,
-0b0000001000000000000000100000010000001000000100000010000001000000,
-0b0000010100000000000001010000100000010000001000000100000010000000,
-0b0000101000000000000010100001000100100000010000001000000000000000,
-0b0001010000000000000101000010001001000001100000000000000000000000,
-0b0010100000000000001010000100010010000010000000010000000000000000,
-0b0101000000000000010100001000100000000100000000100000000100000000,
-0b1010000000000000101000000001000000001000000001000000001000000001,
-0b0100000000000000010000000010000000010000000010000000010000000010,
-0b0000000000000010000001000000100000010000001000000100000010000000,
-0b0000000000000101000010000001000000100000010000001000000000000000,
-0b0000000000001010000100010010000001000000100000000000000000000000,
-0b0000000000010100001000100100000110000000000000000000000000000000,
-0b0000000000101000010001001000001000000001000000000000000000000000,
-0b0000000001010000100010000000010000000010000000010000000000000000,
-0b0000000010100000000100000000100000000100000000100000000100000000,
-0b0000000001000000001000000001000000001000000001000000001000000001,
+  // the magic numbers are found by lookup_generator, see Attacks.h
+inline constexpr u_long64_t rook_magic_numbers[64] = {
+0x0080008020104000ULL,
+0xD0C000401000E004ULL,
+0xC880200280285000ULL,
+0x8100041000090020ULL,
+0x0200081042004520ULL,
+0x0300020900080C00ULL,
+0x0200020001008804ULL,
+0x2200110020440082ULL,
+0x4010800040002080ULL,
+0x0400400050002000ULL,
+0x1001004100200010ULL,
+0x8003005000210018ULL,
+0x8100808008000400ULL,
+0x140A000402008810ULL,
+0xB404001001080204ULL,
+0x0002000611006084ULL,
+0x2100208000804000ULL,
+0x8430004040002003ULL,
+0x4288110020004100ULL,
+0x3200808008001004ULL,
+0x0A00808004000800ULL,
+0x5000808004000200ULL,
+0x0200AC0012080910ULL,
+0x4080060000408904ULL,
+0x40C0004080208001ULL,
+0x2310014640012000ULL,
+0x0100200180100182ULL,
+0x0200100080080080ULL,
+0x0000040080080080ULL,
+0x4804008080040200ULL,
+0x0808020080800100ULL,
+0x4400404200008401ULL,
+0x4000400094800020ULL,
+0x4000208102004200ULL,
+0x0890002400200800ULL,
+0x0110001080800800ULL,
+0x0110800800800400ULL,
+0x1016001002000804ULL,
+0xE000020001010004ULL,
+0x0084010082000044ULL,
+0x0000308040008002ULL,
+0x0810402010004009ULL,
+0x0802002040820010ULL,
+0x4000100100210008ULL,
+0x1200080004008080ULL,
+0x010E820004008080ULL,
+0x0020280130440002ULL,
+0x2000240A84420001ULL,
+0x0440400020800080ULL,
+0x8311802000400A80ULL,
+0x2160200484100080ULL,
+0x0000084200102200ULL,
+0x0104008004080080ULL,
+0x0284000402008080ULL,
+0x503818461D501400ULL,
+0x00000C0104608200ULL,
+0x0084800112204701ULL,
+0x0100224011020582ULL,
+0x0004408922001082ULL,
+0x2405000420900009ULL,
+0x0801002C18001003ULL,
+0x5612005081040802ULL,
+0x2000008208013004ULL,
+0x2C00040088310442ULL,
 };
 
-const u_long64_t rook_lookup[64] = {
-0b0000000100000001000000010000000100000001000000010000000111111110,
-0b0000001000000010000000100000001000000010000000100000001011111101,
-0b0000010000000100000001000000010000000100000001000000010011111011,
-0b0000100000001000000010000000100000001000000010000000100011110111,
-0b0001000000010000000100000001000000010000000100000001000011101111,
-0b0010000000100000001000000010000000100000001000000010000011011111,
-0b0100000001000000010000000100000001000000010000000100000010111111,
-0b1000000010000000100000001000000010000000100000001000000001111111,
-0b0000000100000001000000010000000100000001000000011111111000000001,
-0b0000001000000010000000100000001000000010000000101111110100000010,
-0b0000010000000100000001000000010000000100000001001111101100000100,
-0b0000100000001000000010000000100000001000000010001111011100001000,
-0b0001000000010000000100000001000000010000000100001110111100010000,
-0b0010000000100000001000000010000000100000001000001101111100100000,
-0b0100000001000000010000000100000001000000010000001011111101000000,
-0b1000000010000000100000001000000010000000100000000111111110000000,
-0b0000000100000001000000010000000100000001111111100000000100000001,
-0b0000001000000010000000100000001000000010111111010000001000000010,
-0b0000010000000100000001000000010000000100111110110000010000000100,
-0b0000100000001000000010000000100000001000111101110000100000001000,
-0b0001000000010000000100000001000000010000111011110001000000010000,
-0b0010000000100000001000000010000000100000110111110010000000100000,
-0b0100000001000000010000000100000001000000101111110100000001000000,
-0b1000000010000000100000001000000010000000011111111000000010000000,
-0b0000000100000001000000010000000111111110000000010000000100000001,
-0b0000001000000010000000100000001011111101000000100000001000000010,
-0b0000010000000100000001000000010011111011000001000000010000000100,
-0b0000100000001000000010000000100011110111000010000000100000001000,
-0b0001000000010000000100000001000011101111000100000001000000010000,
-0b0010000000100000001000000010000011011111001000000010000000100000,
-0b0100000001000000010000000100000010111111010000000100000001000000,
-0b1000000010000000100000001000000001111111100000001000000010000000,
-0b0000000100000001000000011111111000000001000000010000000100000001,
-0b0000001000000010000000101111110100000010000000100000001000000010,
-0b0000010000000100000001001111101100000100000001000000010000000100,
-0b0000100000001000000010001111011100001000000010000000100000001000,
-0b0001000000010000000100001110111100010000000100000001000000010000,
-0b0010000000100000001000001101111100100000001000000010000000100000,
-0b0100000001000000010000001011111101000000010000000100000001000000,
-0b1000000010000000100000000111111110000000100000001000000010000000,
-0b0000000100000001111111100000000100000001000000010000000100000001,
-0b0000001000000010111111010000001000000010000000100000001000000010,
-0b0000010000000100111110110000010000000100000001000000010000000100,
-0b0000100000001000111101110000100000001000000010000000100000001000,
-0b0001000000010000111011110001000000010000000100000001000000010000,
-0b0010000000100000110111110010000000100000001000000010000000100000,
-0b0100000001000000101111110100000001000000010000000100000001000000,
-0b1000000010000000011111111000000010000000100000001000000010000000,
-0b0000000111111110000000010000000100000001000000010000000100000001,
-0b0000001011111101000000100000001000000010000000100000001000000010,
-0b0000010011111011000001000000010000000100000001000000010000000100,
-0b0000100011110111000010000000100000001000000010000000100000001000,
-0b0001000011101111000100000001000000010000000100000001000000010000,
-0b0010000011011111001000000010000000100000001000000010000000100000,
-0b0100000010111111010000000100000001000000010000000100000001000000,
-0b1000000001111111100000001000000010000000100000001000000010000000,
-0b1111111000000001000000010000000100000001000000010000000100000001,
-0b1111110100000010000000100000001000000010000000100000001000000010,
-0b1111101100000100000001000000010000000100000001000000010000000100,
-0b1111011100001000000010000000100000001000000010000000100000001000,
-0b1110111100010000000100000001000000010000000100000001000000010000,
-0b1101111100100000001000000010000000100000001000000010000000100000,
-0b1011111101000000010000000100000001000000010000000100000001000000,
-0b0111111110000000100000001000000010000000100000001000000010000000,
+inline constexpr u_long64_t bishop_magic_numbers[64] = {
+0x000220040400802CULL,
+0x2002089204004400ULL,
+0x21314800810A0000ULL,
+0x00020A0208808401ULL,
+0x0244050402000040ULL,
+0x000A091420000002ULL,
+0x300088080806A060ULL,
+0x5822004104100200ULL,
+0x0122605C100200D0ULL,
+0x0810290801024208ULL,
+0x0000083810419080ULL,
+0x0001182042425040ULL,
+0x0080511040080002ULL,
+0x00A400882008A080ULL,
+0x300144008404A00CULL,
+0x0000411441042004ULL,
+0xB024014009620420ULL,
+0x090818601A449214ULL,
+0x4001000208020380ULL,
+0x008A104840810040ULL,
+0x4004020202312200ULL,
+0x0090800040602001ULL,
+0x0305284288080208ULL,
+0x000020004A180400ULL,
+0x0004100604105020ULL,
+0x0208046120040080ULL,
+0x0014280004004400ULL,
+0x0042002028008020ULL,
+0x0802008406008080ULL,
+0x0488810806011000ULL,
+0x8040810084211830ULL,
+0x0004808522104420ULL,
+0x2488084040880280ULL,
+0x4004128200085000ULL,
+0x0012044100100904ULL,
+0x0000020080080082ULL,
+0x0011020400080410ULL,
+0x0012102040060800ULL,
+0x0012020202004820ULL,
+0x1401040500408070ULL,
+0x000084200A182080ULL,
+0x2600410808002008ULL,
+0x5408201048101008ULL,
+0x0200020124000200ULL,
+0x8008203410108100ULL,
+0x0208101103482200ULL,
+0x00283001C2868A10ULL,
+0x0004188400420304ULL,
+0x0562082208050818ULL,
+0x52004D041002404CULL,
+0x80A0008088210010ULL,
+0x021001A084040004ULL,
+0x00C2002004240042ULL,
+0x8180100410043080ULL,
+0x08108222880E0000ULL,
+0x0024104402409000ULL,
+0x4006010088048211ULL,
+0x0040108404220280ULL,
+0x100000204A080408ULL,
+0x0010001100840408ULL,
+0x600F000440882208ULL,
+0x4000001042108102ULL,
+0x3080642458020410ULL,
+0x8103C81000808100ULL,
 };
 
 };
@@ -2,11 +2,70 @@ class GameState;  // Forward declaration
 
 #include "../src/Piece.cpp"
 #include <array>
+#include <string_view>
 
 #pragma once
 
+/**
+ * @brief Why FenParser::parse_fen rejected a string, FenError::None when it was accepted.
+ * FenParser::error_message gives a readable description.
+ */
+enum class FenError {
+  None,
+  // fewer than the 4 fields of an EPD
+  MissingFields,
+  UnknownPiece,
+  // not 8 ranks of 8 squares
+  BoardSize,
+  // not exactly one king of each colour
+  KingCount,
+  PawnOnBackRank,
+  // more pawns or promoted pieces than a game can have, see Position::is_possible_material
+  Material,
+  // the king of the side that just moved is in check, it could be captured
+  OpponentInCheck,
+  SideToMove,
+  // unknown letter, or the king or rook of a castling right is not on its square
+  CastlingRights,
+  // not a square on the 3rd or 6th rank behind a pawn of the side that just moved
+  EnPassantSquare,
+  // clocks that are not non negative numbers
+  Clocks
+};
+
 class FenParser {
 public:
-  static std::array<int, 64> parse_board(const std::string &fen_string);
+  /**
+   * @brief Parse the board field of a FEN into board, without allocating or throwing.
+   * Only the pieces and the size of the board are checked here, the rest is checked by parse_fen.
+  */
+  static FenError parse_board(std::string_view board_string, std::array<int, 64> &board) noexcept;
+
+  // same as above, throws std::invalid_argument on invalid boards
+  static std::array<int, 64> parse_board(std::string_view board_string);
+
+  /**
+   * @brief Parse a FEN into a new GameState.
+   * @throws std::invalid_argument with the error_message if the string is not a valid position.
+  */
   static GameState parse_fen(const std::string &fen_string);
+
+  /**
+   * @brief Parse a FEN or an EPD line into an existing game, which is reset with GameState::set_position.
+   *
+   * Meant for untrusted input and for parsing millions of positions: nothing is allocated and nothing is thrown,
+   * malformed input only returns an error code and leaves game unchanged. Legal moves are not generated,
+   * the game generates them when they are first asked for.
+   * The position is validated so that the move generator can not be broken by it, see FenError.
+   *
+   * EPD lines have only the first four fields followed by operations like "bm Nf3; id \"1\";",
+   * the operations are ignored and the clocks are set to 0 and 1.
+   *
+   * \b Example: GameState game; if(FenParser::parse_fen(line, game) != FenError::None) { ... }
+   *
+   * @return FenError::None if the game was set to the position.
+  */
+  static FenError parse_fen(std::string_view fen_string, GameState &game) noexcept;
+
+  static const char *error_message(FenError error) noexcept;
 };
\ No newline at end of file
@@ -1,5 +1,4 @@
-#include "Move.h"
-#include "../src/Piece.cpp"
+#include "Position.h"
 #include <array>
 #include <vector>
 
@@ -11,7 +10,7 @@
  *
  * This struct holds the current state of a chess game, including the castling rights,
  * the en passant square, the squares of the white and black kings, the last piece
- * that was captured, the halfmove clock for the fifty-move rule, and the fullmove counter.
+ * that was captured, the halfmove clock for the fifty-move rule, the fullmove counter and the zobrist key.
  *
  * It is used to undo moves, each move, a new GameData struct is stored in game_history vector.
  */
@@ -23,17 +22,56 @@ struct GameData {
   int captured_piece;
   int halfmove_clock;
   int fullmove_counter;
+  u_long64_t zobrist_key;
 
   GameData(char castling_rights, char en_passant_square, char white_king_square,
-    char black_king_square, int captured_piece, int halfmove_clock, int fullmove_counter)
+    char black_king_square, int captured_piece, int halfmove_clock, int fullmove_counter, u_long64_t zobrist_key)
     : castling_rights(castling_rights), en_passant_square(en_passant_square),
       white_king_square(white_king_square), black_king_square(black_king_square),
       captured_piece(captured_piece), halfmove_clock(halfmove_clock),
-      fullmove_counter(fullmove_counter) {};
+      fullmove_counter(fullmove_counter), zobrist_key(zobrist_key) {};
 };
 
-class GameState {
+/**
+ * @brief A chess game, a Position together with the moves played to reach it.
+ * Keeps the history needed by undo_move and caches the legal moves of the current position.
+ *
+ * The Position is inherited protected: the queries and fields of the position are public, but it only changes
+ * through make_move, undo_move and set_position, which keep the cached legal moves and the history in sync.
+ * position() gives the Position itself, e.g. for Perft, a StagedMoveGenerator or as the parent of copy-make.
+ */
+class GameState : protected Position {
 public:
+  const Position &position() const { return *this; }
+
+  using Position::is_square_attacked;
+  using Position::attacked_squares;
+  using Position::attackers_to;
+  using Position::pinned_pieces;
+  using Position::generate_legal_moves;
+  using Position::generate_captures;
+  using Position::get_rank;
+  using Position::get_file;
+  using Position::compute_zobrist_key;
+  using Position::to_fen;
+  using Position::to_epd;
+  using Position::pieces;
+  using Position::occupancy;
+  using Position::to_move;
+
+  // the fields are public for reading, writing them directly leaves the cached legal moves out of date
+  using Position::board;
+  using Position::piece_bitboards;
+  using Position::colour_bitboards;
+  using Position::turn;
+  using Position::castling_rights;
+  using Position::en_passant_target;
+  using Position::white_king_square;
+  using Position::black_king_square;
+  using Position::halfmove_clock;
+  using Position::fullmove_counter;
+  using Position::zobrist_key;
+
   /**
    * @brief This constructor is used by FenParser to create a new game from fen
    *
@@ -48,6 +86,16 @@ public:
  */
   GameState(const std::array<int, 64> &board, int turn, char castling_rights, char en_passant_square, int halfmove_clock, int fullmove_counter);
 
+  /**
+   * @brief Replace the whole game with a new position, parameters are the same as in the constructor above.
+   * The move history is cleared but keeps its memory, so a GameState can be reused for many positions
+   * without allocating, see FenParser::parse_fen(std::string_view, GameState&).
+   *
+   * @return false if a king is missing or the material is impossible (Position::is_possible_material),
+   * the game is left unchanged then.
+  */
+  bool set_position(const std::array<int, 64> &board, int turn, char castling_rights, char en_passant_square, int halfmove_clock, int fullmove_counter) noexcept;
+
   /**
    * @brief Constructs a new GameState object with default parameters.
    * Initializes a new GameState object with a default board.
@@ -57,7 +105,8 @@ public:
   /**
    * @brief Make a move if it is legal.
    * 
-   * First this function checks if the move is legal, by searching for it in legal_moves vector.
+   * First this function checks if the move is legal, by searching for it in the legal moves
+   * (generating them if they were not generated yet for this position).
    * Then if it is, it makes the move and updates the GameState params like:
    * board, turn, castling rights, en passant square etc.
    *
@@ -65,6 +114,18 @@ public:
   */
   void make_move(const Move &move);
 
+  /**
+   * @brief Make a move without checking if it is legal.
+   * Meant for callers that loop over moves they just got from get_legal_move_list,
+   * like perft or a search, where looking the move up again would be wasted work.
+   * Making an illegal move leaves the GameState in an invalid state.
+   *
+   * @param Move A legal move to make.
+  */
+  void make_move_unchecked(PackedMove move);
+  // the same for a Move, e.g. one of get_legal_moves
+  void make_move_unchecked(const Move &move) { make_move_unchecked(PackedMove(move)); }
+
   /**
    * @brief Make a move represented in the Long Algebraic notation, examples in Move.h
    * Rest is the same as make_move from Move object
@@ -73,6 +134,30 @@ public:
   */
   void make_move(const std::string &move);
 
+  /**
+   * @brief Make a move given in UCI coordinate notation (e2e4, e7e8q, castles as the king move e1g1) if it is legal.
+   * Garbage and illegal moves only return false, nothing is thrown and the game is not changed then.
+   * The move is looked up with find_legal_move, so the cost does not depend on the number of legal moves.
+   *
+   * @return true if the move was made.
+  */
+  bool make_move_uci(std::string_view move);
+
+  /**
+   * @brief Find the legal move of the side to move with the given squares and promotion.
+   * The legal moves are indexed by their start square once per position, after that every lookup
+   * is a bitboard test, the flags of the move (capture, en passant, castle ...) come from the board.
+   *
+   * @param promotion Piece type the pawn promotes to, Piece::NonePiece if the move is not a promotion.
+   * @param move Set to the legal move if there is one.
+   * @return false if there is no such legal move.
+  */
+  bool find_legal_move(int start, int end, int promotion, Move &move);
+
+  // copy-make from Position, it is hidden by the make_move overloads above otherwise,
+  // the child is a Position, a GameState can not be written to this way
+  using Position::make_move;
+
   /**
    * @brief Undo the last move stored in the moves_played
    * Pops the move from moves_played and pops GameData from game_history.
@@ -81,77 +166,32 @@ public:
   void undo_move();
 
   /**
-   * @brief Check if a given move of any piece other than the King is legal.
-   * Function used in legal move generation. Once all pseudolegal moves are generated, it checks
-   * if after each move, the king square is attacked. If it is, the move is illegal.
-   * 
-   * @param move Move to check if it is legal.
-   * 
-   * @return true if it is legal.
-   * 
+   * @brief Number of legal moves of the side to move, the size of the cached list if it was generated already.
   */
-  bool is_figure_move_legal(const Move &move);
-
-  /**
-   * @brief Check if a given King Move is legal.
-   * Once all king moves, including castles are generated, this function checks if the king is attacked
-   * on the end square, if the move is a castle, it also checks if it was attacked on any of the squares during castling
-   * and if it was, the move is illegal.
-   * 
-   * @return true if it is legal.
-   * 
-   */
-  bool is_king_move_legal(const Move &move);
+  int count_legal_moves() const;
 
+  // copy of the current legal moves as Moves, with their pieces
+  std::vector<Move> get_legal_moves();
   /**
-   * @brief Check if a square is attacked.
-   * 
-   * @param square The square to check if it is attacked.
-   * @param color The color of our pieces. The color of the piece on target square.
-   * 
+   * @brief The current legal moves without copying them, valid until the next make_move or undo_move.
+   * The moves are generated on the first call after the position changed and cached until the next change.
   */
-  bool is_square_attacked(int square, char color);
-
-  std::vector<Move> generate_legal_moves(char color);
-  std::vector<Move> generate_pawn_moves(int square);
-  std::vector<Move> generate_knight_moves(int square, char color = 0);
-  std::vector<Move> generate_diagonal_sliding_moves(int square, char color = 0);
-  std::vector<Move> generate_straight_sliding_moves(int square, char color = 0);
-  std::vector<Move> generate_king_moves(int square, char color = 0);
-
-  std::vector<Move> get_legal_moves() const;
-
-  int get_rank(int square) const;
-  int get_file(int square) const;
+  const MoveList &get_legal_move_list();
 
   void print_board() const;
 
-  std::array<int, 64> board;
-  // Piece::White is white, Piece::Black is black
-  int turn;
-  // 0 represents full castling rights
-  char castling_rights;
-  // square where en passant is possible
-  // index of square behind the pawn that moved two squares
-  char en_passant_target;
-
-  char white_king_square = -1;
-  char black_king_square = -1;
-
-  // number of half moves since last capture or pawn move
-  int halfmove_clock = 0;
-  int fullmove_counter = 0;
-
 private:
-  // current legal moves
-  std::vector<Move> legal_moves;
-  std::vector<Move> moves_played;
-  std::vector<GameData> game_history;
-
-  static const char WHITE_QUEENSIDE_SQUARES[2];
-  static const char WHITE_KINGSIDE_SQUARES[2];
-  static const char BLACK_QUEENSIDE_SQUARES[2];
-  static const char BLACK_KINGSIDE_SQUARES[2];
+  // undo_move for the colour Us that made the last move
+  template<int Us>
+  void undo_move();
 
-  static const char NO_EN_PASSANT = -1;
+  // current legal moves, only valid when legal_moves_generated is true
+  MoveList legal_moves;
+  bool legal_moves_generated = false;
+  // squares each piece can legally move to, indexed by the start square,
+  // built from legal_moves by find_legal_move and only valid when legal_targets_generated is true
+  std::array<u_long64_t, 64> legal_targets;
+  bool legal_targets_generated = false;
+  std::vector<PackedMove> moves_played;
+  std::vector<GameData> game_history;
 };
\ No newline at end of file
@@ -3,12 +3,36 @@
 #include <vector>
 #include <array>
 #include <string>
+#include <string_view>
+#include <cstdint>
+#include <algorithm>
+
+#pragma once
 
 class Move {
 public:
-    // Constructor
+    // tag selecting the unchecked constructor
+    struct Unchecked {};
+    static constexpr Unchecked UNCHECKED = {};
+
+    /**
+     * @brief Constructor for moves coming from outside, like parsed moves or tests.
+     * @throws std::invalid_argument if a square is not on the board.
+     */
     Move(int start, int end, int piece, int flags = 0);
 
+    /**
+     * @brief Constructor without any checks, used by the move generators, whose squares are always on the board.
+     * Without the throwing path the compiler can inline it into the generators.
+     *
+     * \b Example: moves.push_back(Move(Move::UNCHECKED, start, target, piece, Move::CAPTURE));
+     */
+    constexpr Move(Unchecked, int start, int end, int piece, int flags) noexcept
+        : start(start), end(end), piece(piece), flags(flags) {};
+
+    // leaves the move uninitialized, used for the storage of MoveList
+    Move() = default;
+
     int start;
     int end;
     int piece;
@@ -16,8 +40,12 @@ public:
 
     // overloaded operators
     friend std::ostream& operator<<(std::ostream &os, const Move &move);
-    bool operator==(const Move &other) const;
-    bool operator!=(const Move &other) const;
+    constexpr bool operator==(const Move &other) const noexcept {
+        return start == other.start && end == other.end && piece == other.piece && flags == other.flags;
+    }
+    constexpr bool operator!=(const Move &other) const noexcept {
+        return !(*this == other);
+    }
     // used only in tests: 
     bool operator<(const Move &other) const;
     bool operator>(const Move &other) const;
@@ -38,6 +66,18 @@ public:
      */
     static std::array<int, 4> parse_lan(const std::string &lan_str);
 
+    /**
+     * @brief Parses a move in UCI coordinate notation, without allocating or throwing.
+     *
+     * Examples: \b e2e4, promotion \b e7e8q, castles are the king move \b e1g1.
+     * The string is only checked to be well formed, GameState::find_legal_move matches it with a legal move.
+     *
+     * @param start, end The squares of the move.
+     * @param promotion Piece type the pawn promotes to (Piece::Queen, ...), Piece::NonePiece without a promotion.
+     * @return false if the string is not a move in coordinate notation.
+     */
+    static bool parse_uci(std::string_view uci_str, int &start, int &end, int &promotion) noexcept;
+
     /**
      * @brief Returns a lan string of the current move object.
      *
@@ -54,27 +94,94 @@ public:
     std::string lan_str() const;
     std::string perft_str() const;
     
-    static bool is_normal(int flags);
-    static bool is_capture(int flags);
-    static bool is_en_passant(int flags);
-    static bool is_double_push(int flags);
-    static bool is_castle_kingside(int flags);
-    static bool is_castle_queenside(int flags);
-    static bool is_castle(int flags);
-    static bool is_promotion_queen(int flags);
-    static bool is_promotion_rook(int flags);
-    static bool is_promotion_bishop(int flags);
-    static bool is_promotion_knight(int flags);
-    static bool is_promotion(int flags);
-
-    static const int NORMAL = 1;
-    static const int CAPTURE = 2;
-    static const int EN_PASSANT = 4;
-    static const int DOUBLE_PUSH = 8;
-    static const int CASTLE_KINGSIDE = 16;
-    static const int CASTLE_QUEENSIDE = 32;
-    static const int PROMOTION_QUEEN = 64;
-    static const int PROMOTION_ROOK = 128;
-    static const int PROMOTION_BISHOP = 256;
-    static const int PROMOTION_KNIGHT = 512;
-};
\ No newline at end of file
+    static constexpr bool is_normal(int flags) noexcept { return (flags & NORMAL) == NORMAL; }
+    static constexpr bool is_capture(int flags) noexcept { return (flags & CAPTURE) == CAPTURE; }
+    static constexpr bool is_en_passant(int flags) noexcept { return (flags & EN_PASSANT) == EN_PASSANT; }
+    static constexpr bool is_double_push(int flags) noexcept { return (flags & DOUBLE_PUSH) == DOUBLE_PUSH; }
+    static constexpr bool is_castle_kingside(int flags) noexcept { return (flags & CASTLE_KINGSIDE) == CASTLE_KINGSIDE; }
+    static constexpr bool is_castle_queenside(int flags) noexcept { return (flags & CASTLE_QUEENSIDE) == CASTLE_QUEENSIDE; }
+    static constexpr bool is_castle(int flags) noexcept { return (flags & (CASTLE_KINGSIDE | CASTLE_QUEENSIDE)) != 0; }
+    static constexpr bool is_promotion_queen(int flags) noexcept { return (flags & PROMOTION_QUEEN) == PROMOTION_QUEEN; }
+    static constexpr bool is_promotion_rook(int flags) noexcept { return (flags & PROMOTION_ROOK) == PROMOTION_ROOK; }
+    static constexpr bool is_promotion_bishop(int flags) noexcept { return (flags & PROMOTION_BISHOP) == PROMOTION_BISHOP; }
+    static constexpr bool is_promotion_knight(int flags) noexcept { return (flags & PROMOTION_KNIGHT) == PROMOTION_KNIGHT; }
+    static constexpr bool is_promotion(int flags) noexcept {
+        return (flags & (PROMOTION_QUEEN | PROMOTION_ROOK | PROMOTION_BISHOP | PROMOTION_KNIGHT)) != 0;
+    }
+
+    static constexpr int NORMAL = 1;
+    static constexpr int CAPTURE = 2;
+    static constexpr int EN_PASSANT = 4;
+    static constexpr int DOUBLE_PUSH = 8;
+    static constexpr int CASTLE_KINGSIDE = 16;
+    static constexpr int CASTLE_QUEENSIDE = 32;
+    static constexpr int PROMOTION_QUEEN = 64;
+    static constexpr int PROMOTION_ROOK = 128;
+    static constexpr int PROMOTION_BISHOP = 256;
+    static constexpr int PROMOTION_KNIGHT = 512;
+};
+
+/**
+ * @brief A move packed into 16 bits, used where many moves are stored: move lists and the move history.
+ *
+ * Bits 0-5 hold the start square, bits 6-11 the end square and bits 12-15 the kind of the move:
+ * 0 normal, 1 double push, 2 kingside castle, 3 queenside castle, 4 capture, 5 en passant,
+ * 8-11 promotion to knight, bishop, rook, queen and 12-15 the same promotions with a capture.
+ *
+ * The moving piece is not stored, it is on the start square of the board before the move is made,
+ * so converting back to a Move needs the piece from the caller, see Position::to_move.
+ *
+ * \b Example: PackedMove packed(move); Move move2 = packed.to_move(game.board[packed.start()]);
+ */
+class PackedMove {
+public:
+    PackedMove() = default;
+    explicit PackedMove(const Move &move);
+    constexpr PackedMove(int start, int end, int kind) noexcept
+        : data((uint16_t)(start | (end << 6) | (kind << 12))) {};
+
+    constexpr int start() const noexcept { return data & 0x3F; }
+    constexpr int end() const noexcept { return (data >> 6) & 0x3F; }
+    constexpr int kind() const noexcept { return data >> 12; }
+    // the kind converted back to Move flags, e.g. Move::PROMOTION_QUEEN | Move::CAPTURE
+    int flags() const;
+
+    // the same meaning as the Move flags of the same name, a capture en passant is not is_capture
+    constexpr bool is_capture() const noexcept { return (kind() & CAPTURE) != 0 && kind() != EN_PASSANT; }
+    constexpr bool is_en_passant() const noexcept { return kind() == EN_PASSANT; }
+    constexpr bool is_double_push() const noexcept { return kind() == DOUBLE_PUSH; }
+    constexpr bool is_castle() const noexcept { return kind() == CASTLE_KINGSIDE || kind() == CASTLE_QUEENSIDE; }
+    constexpr bool is_castle_kingside() const noexcept { return kind() == CASTLE_KINGSIDE; }
+    constexpr bool is_promotion() const noexcept { return (kind() & PROMOTION) != 0; }
+    // piece type a promotion promotes to, e.g. Piece::Queen
+    constexpr int promotion_piece() const noexcept {
+        constexpr int PIECES[4] = {Piece::Knight, Piece::Bishop, Piece::Rook, Piece::Queen};
+        return PIECES[kind() & 3];
+    }
+
+    Move to_move(int piece) const;
+
+    // same as Move::lan_str, the piece is needed for the piece letter
+    std::string lan_str(int piece) const;
+    std::string perft_str() const;
+
+    constexpr bool operator==(const PackedMove &other) const noexcept { return data == other.data; }
+    constexpr bool operator!=(const PackedMove &other) const noexcept { return data != other.data; }
+    // used only in tests, to compare lists of moves in any order
+    constexpr bool operator<(const PackedMove &other) const noexcept { return data < other.data; }
+
+    uint16_t data;
+
+    static constexpr int NORMAL = 0;
+    static constexpr int DOUBLE_PUSH = 1;
+    static constexpr int CASTLE_KINGSIDE = 2;
+    static constexpr int CASTLE_QUEENSIDE = 3;
+    static constexpr int CAPTURE = 4;
+    static constexpr int EN_PASSANT = 5;
+    // promotions have this bit set, the lowest two bits select the piece, CAPTURE bit can be added
+    static constexpr int PROMOTION = 8;
+    static constexpr int PROMOTION_KNIGHT = 8;
+    static constexpr int PROMOTION_BISHOP = 9;
+    static constexpr int PROMOTION_ROOK = 10;
+    static constexpr int PROMOTION_QUEEN = 11;
+};
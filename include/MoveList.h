@@ -0,0 +1,67 @@
+#include "Move.h"
+#include <cassert>
+
+#pragma once
+
+/**
+ * @brief Fixed capacity list of moves, stored on the stack so that generating moves does not allocate.
+ * The moves are stored as 16 bit PackedMoves, a full list is about 650 bytes instead of 5 KB of Moves,
+ * Position::to_move gives the Move with its piece.
+ *
+ * Legal positions have at most 218 moves, but the parser and GameState::set_position only check the material
+ * (Position::is_possible_material), so the capacity is a bound that holds for every such position: one king
+ * with at most 8 moves, one queen, two rooks, two bishops and two knights with at most 27, 14, 13 and 8 moves,
+ * and 8 pawns or pieces promoted from them with at most 27 moves each (a pawn has at most 12).
+ * Copying a MoveList copies only the moves that are in it.
+ *
+ * \b Example: MoveList moves; game.generate_legal_moves(game.turn, moves); Move move = game.to_move(moves[0]);
+ */
+class MoveList {
+public:
+    MoveList() : count(0) {};
+
+    MoveList(const MoveList &other) : count(other.count) {
+        std::copy(other.begin(), other.end(), moves);
+    }
+
+    MoveList &operator=(const MoveList &other) {
+        count = other.count;
+        std::copy(other.begin(), other.end(), moves);
+        return *this;
+    }
+
+    void push_back(PackedMove move) noexcept {
+        assert(count < CAPACITY);
+        moves[count++] = move;
+    }
+
+    void clear() noexcept {
+        count = 0;
+    }
+
+    int size() const {
+        return count;
+    }
+
+    bool empty() const {
+        return count == 0;
+    }
+
+    bool contains(PackedMove move) const {
+        return std::find(begin(), end(), move) != end();
+    }
+
+    PackedMove &operator[](int index) { return moves[index]; }
+    const PackedMove &operator[](int index) const { return moves[index]; }
+
+    PackedMove *begin() { return moves; }
+    PackedMove *end() { return moves + count; }
+    const PackedMove *begin() const { return moves; }
+    const PackedMove *end() const { return moves + count; }
+
+    static const int CAPACITY = 8 + 27 + 2 * 14 + 2 * 13 + 2 * 8 + 8 * 27;
+
+private:
+    int count;
+    PackedMove moves[CAPACITY];
+};
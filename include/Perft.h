@@ -0,0 +1,86 @@
+#include "GameState.h"
+#include <atomic>
+#include <map>
+#include <memory>
+#include <string>
+
+#pragma once
+
+/**
+ * @brief Transposition table for perft, maps (zobrist key, depth) to the number of nodes below that position.
+ *
+ * The same position is often reached by different move orders, with the table its subtree is counted only once.
+ * The table has a fixed size given in megabytes and every store replaces the entry in its slot.
+ * The key is stored xored with the data, so an entry that is only partially written never matches,
+ * which lets many threads share one table without locks.
+ */
+class PerftTable {
+public:
+  /**
+   * @param size_mb Size of the table in megabytes, rounded down to a power of two number of entries.
+  */
+  explicit PerftTable(size_t size_mb);
+
+  /**
+   * @brief Look up the node count of a position at a given depth.
+   *
+   * @return true if the entry was found, the count is written to nodes.
+  */
+  bool probe(u_long64_t key, int depth, u_long64_t &nodes) const;
+  void store(u_long64_t key, int depth, u_long64_t nodes);
+  void clear();
+
+  size_t size() const { return count; }
+
+private:
+  struct Entry {
+    // zobrist key xored with data
+    std::atomic<u_long64_t> key;
+    // node count in the upper 56 bits, depth in the lowest 8 bits
+    std::atomic<u_long64_t> data;
+  };
+
+  std::unique_ptr<Entry[]> entries;
+  size_t count;
+  size_t mask;
+};
+
+/**
+ * @brief Counts leaf nodes of the legal move tree, used to verify the move generator.
+ *
+ * \b Example: GameState game = FenParser::parse_fen(STARTING_FEN); Perft::perft(game.position(), 5) == 4865609
+ *
+ * Results for many positions are at https://www.chessprogramming.org/Perft_Results
+ */
+class Perft {
+public:
+  /**
+   * @brief Number of leaf nodes at the given depth, counted with copy-make so the position is not changed.
+  */
+  static u_long64_t perft(const Position &position, int depth);
+
+  /**
+   * @brief Same as perft, but subtrees of positions that were already counted are read from the table.
+  */
+  static u_long64_t perft(const Position &position, int depth, PerftTable &table);
+
+  /**
+   * @brief Number of leaf nodes after each root move, keyed by Move::perft_str.
+   *
+   * @param table Optional transposition table, nullptr to count without one.
+  */
+  static std::map<std::string, u_long64_t> divide(const Position &position, int depth, PerftTable *table = nullptr);
+
+  /**
+   * @brief Same result as divide, counted on many threads.
+   *
+   * The tree is split into one task per position split_ply moves below the root, the tasks run
+   * on a work stealing ThreadPool, every task holds its own copy of the position.
+   *
+   * @param threads Number of worker threads.
+   * @param split_ply Depth at which the tree is split into tasks, deeper gives more and smaller tasks.
+   * @param table Optional transposition table shared by all threads, nullptr to count without one.
+  */
+  static std::map<std::string, u_long64_t> parallel_divide(const Position &position, int depth, int threads,
+    int split_ply = 2, PerftTable *table = nullptr);
+};
@@ -0,0 +1,303 @@
+#include "Move.h"
+#include "MoveList.h"
+#include "Bitboard.h"
+#include "Zobrist.h"
+#include "Attacks.h"
+#include "../src/Piece.cpp"
+#include <array>
+#include <cstddef>
+#include <string_view>
+#include <type_traits>
+
+#pragma once
+
+/**
+ * @brief Which legal moves generate_legal_moves produces.
+ *
+ * Tactical moves are captures, en passant and all promotions, quiet moves are all the other moves,
+ * so together the two give exactly the moves of All.
+ * Captures are the moves searched in quiescence: captures, en passant and promotions to a queen only.
+ */
+enum class GenType {
+  Tactical,
+  Quiet,
+  All,
+  Captures
+};
+
+/**
+ * @struct Position
+ * @brief The board and everything needed to generate legal moves, without any history.
+ *
+ * Position is trivially copyable, so copying it is a plain memcpy of a few hundred bytes.
+ * Search and perft can use copy-make: make_move writes the position after a move into another Position
+ * (usually the next one on a stack), and "undoing" the move is simply going back to the parent.
+ * GameState extends it with the move history, undo_move and the cached legal moves.
+ */
+struct Position {
+  /**
+   * @brief Check if a square is attacked.
+   * 
+   * @param square The square to check if it is attacked.
+   * @param color The color of our pieces. The color of the piece on target square.
+   * 
+  */
+  bool is_square_attacked(int square, char color) const;
+
+  /**
+   * @brief Bitboard of all squares attacked by pieces of a given colour.
+   * Used to filter king moves and castles, computed once per position.
+   *
+   * @param color The colour of the attacking pieces.
+   * @param occupancy Occupancy used for sliding pieces, the king generator removes its own king from it.
+  */
+  u_long64_t attacked_squares(char color, u_long64_t occupancy) const;
+
+  /**
+   * @brief Bitboard of all pieces of both colours attacking a square.
+   *
+   * @param square The attacked square.
+   * @param occupancy Occupancy used for sliding pieces, usually occupancy(), can be changed to see through pieces.
+  */
+  u_long64_t attackers_to(int square, u_long64_t occupancy) const;
+
+  /**
+   * @brief Bitboard of pieces of a given colour that are pinned to their own king.
+  */
+  u_long64_t pinned_pieces(char color) const;
+
+  /**
+   * @brief Generate legal moves of a given colour.
+   * Checkers and pinned pieces are found once per position, so only legal moves are generated.
+   * The generators append to the given MoveList, so no memory is allocated.
+   *
+   * @param color The colour to generate moves for.
+   * @param moves MoveList the moves are added to.
+   * @param type Generate only tactical or only quiet moves, see GenType.
+  */
+  void generate_legal_moves(char color, MoveList &moves, GenType type = GenType::All) const;
+
+  /**
+   * @brief Legal captures, en passant captures and queen promotions of the side to move, for quiescence search.
+   * Only the opponent pieces are used as targets, so no quiet move is generated and filtered out.
+  */
+  void generate_captures(MoveList &moves) const;
+
+  /**
+   * @brief Number of legal moves of the side to move.
+   * Counts the targets of every piece with popcount instead of creating Move objects,
+   * so perft can count the last ply without making the moves (bulk counting).
+   *
+   * @return The same number as get_legal_move_list().size().
+  */
+  int count_legal_moves() const;
+
+  /**
+   * @brief Make a move without checking if it is legal, updating this position in place.
+  */
+  void apply_move(PackedMove move);
+
+  /**
+   * @brief Copy-make, writes the position after a legal move into child, this position is not changed.
+   *
+   * \b Example: Position child; game.make_move(move, child);
+   *
+   * @param move A legal move of this position.
+   * @param child Where the new position is written, must not be this position.
+  */
+  void make_move(PackedMove move, Position &child) const;
+
+  /**
+   * @brief The Move of a packed move of this position, the moving piece is taken from the start square.
+  */
+  Move to_move(PackedMove move) const { return move.to_move(board[move.start()]); }
+
+  int get_rank(int square) const;
+  int get_file(int square) const;
+
+  /**
+   * @brief Place a piece on an empty square, updating both the board and the bitboards.
+   * The board array should not be written to directly, otherwise the bitboards get out of sync.
+   * More material than is_possible_material allows can give more moves than a MoveList holds.
+   *
+   * @param square The empty square to place the piece on.
+   * @param piece The piece with its colour, e.g. Piece::White | Piece::Rook.
+  */
+  void put_piece(int square, int piece);
+
+  /**
+   * @brief Remove the piece standing on a given square from the board and the bitboards.
+  */
+  void remove_piece(int square);
+
+  /**
+   * @brief Move a piece from start to an empty end square, updating the board and the bitboards.
+  */
+  void move_piece(int start, int end);
+
+  /**
+   * @brief Remove all pieces from the board.
+  */
+  void clear_board();
+
+  /**
+   * @brief Compute the zobrist key of the position from scratch.
+   * make_move keeps zobrist_key up to date incrementally, this is used to initialise it and to verify it.
+  */
+  u_long64_t compute_zobrist_key() const;
+
+  /**
+   * @brief Check that the material of both sides could come from a real game: at most 8 pawns and 16 pieces
+   * per side, and no more promoted pieces (queens over 1, rooks, bishops and knights over 2) than missing pawns.
+   * Kings are not counted here. Together with one king per side this bounds the number of moves, see MoveList.
+  */
+  static bool is_possible_material(const std::array<int, 64> &board);
+
+  /**
+   * @brief Write the position as FEN into buffer, followed by a terminating null, without allocating.
+   *
+   * \b Example: char fen[Position::MAX_FEN_LENGTH + 1]; position.to_fen(fen, sizeof(fen));
+   *
+   * @return Length of the FEN without the null, 0 if it does not fit into size bytes, nothing is written then.
+  */
+  size_t to_fen(char *buffer, size_t size) const noexcept;
+
+  /**
+   * @brief Write the position as EPD: the first four FEN fields followed by the operations, if there are any.
+   * Buffer and return value are the same as in to_fen.
+   *
+   * \b Example: position.to_epd(buffer, sizeof(buffer), "bm Nf3; id \"1\";");
+  */
+  size_t to_epd(char *buffer, size_t size, std::string_view operations = std::string_view()) const noexcept;
+
+  /**
+   * @brief The slider lookups used by the move generators and attack queries,
+   * PEXT on CPUs where Attacks::cpu_has_fast_pext is true, magics on all others.
+  */
+  static Attacks::SliderBackend get_slider_backend();
+
+  /**
+   * @brief Switch the move generators to another slider backend, used by tests and benchmarks to compare them.
+   * Not thread safe, it should not be called while other threads generate moves.
+   *
+   * @return false if the CPU does not support the backend, the current backend is kept then.
+  */
+  static bool set_slider_backend(Attacks::SliderBackend backend);
+
+  // longest FEN: 64 pieces and 7 slashes, side, 4 castling rights, en passant square and two int clocks
+  static const size_t MAX_FEN_LENGTH = 105;
+
+  // bitboard of all pieces of a given type and colour, e.g. pieces(Piece::Knight, Piece::White)
+  u_long64_t pieces(int piece_type, int color) const {
+    return piece_bitboards[piece_type] & colour_bitboards[Piece::colour_index(color)];
+  }
+
+  // bitboard of all occupied squares
+  u_long64_t occupancy() const {
+    return colour_bitboards[0] | colour_bitboards[1];
+  }
+
+  // rebuild the bitboards from the board array
+  void init_bitboards();
+
+  std::array<int, 64> board;
+
+  // bitboards kept in sync with the board by put_piece, remove_piece and move_piece
+  // piece_bitboards is indexed by Piece::piece_type and holds pieces of both colours,
+  // colour_bitboards is indexed by Piece::colour_index
+  std::array<u_long64_t, 8> piece_bitboards;
+  std::array<u_long64_t, 2> colour_bitboards;
+
+  // Piece::White is white, Piece::Black is black
+  int turn;
+  // 0 represents full castling rights
+  char castling_rights;
+  // square where en passant is possible
+  // index of square behind the pawn that moved two squares
+  char en_passant_target;
+
+  char white_king_square = -1;
+  char black_king_square = -1;
+
+  // number of half moves since last capture or pawn move
+  int halfmove_clock = 0;
+  int fullmove_counter = 0;
+
+  // hash of the pieces, side to move, castling rights and en passant file, see Zobrist.h
+  // equal positions have equal keys
+  u_long64_t zobrist_key = 0;
+
+protected:
+  // The functions below are templated on the colour of the side to move (Us is Piece::White or Piece::Black),
+  // the public functions taking a colour dispatch to them once, so the move directions, promotion ranks and
+  // castling squares are compile time constants in the generators instead of branches.
+  // The ones that look up sliders are also templated on the slider backend B, every backend gets its own copy
+  // of the generators with the lookup inlined, the public functions call the copy picked in slider_functions.
+  template<int Us>
+  int king_square_of() const { return Us == Piece::White ? white_king_square : black_king_square; }
+
+  template<int Us, Attacks::SliderBackend B>
+  void generate_legal_moves(MoveList &moves, GenType type) const;
+  template<int Us, Attacks::SliderBackend B>
+  int count_legal_moves() const;
+  template<int Us, Attacks::SliderBackend B>
+  u_long64_t attacked_squares(u_long64_t occupancy) const;
+  template<int Us, Attacks::SliderBackend B>
+  u_long64_t pinned_pieces() const;
+  template<Attacks::SliderBackend B>
+  u_long64_t attackers_to(int square, u_long64_t occupancy) const;
+  template<int Us>
+  void apply_move(PackedMove move);
+
+  // squares a piece other than a pawn can move to for a type of moves, e.g. the opponent pieces for GenType::Tactical
+  template<int Us>
+  u_long64_t type_targets(GenType type) const;
+  // legal moves when the king is in check, only king moves, captures of the checker and blocks are generated
+  template<int Us, Attacks::SliderBackend B>
+  void generate_evasions(u_long64_t checkers, MoveList &moves) const;
+  // add the move of a pawn from start to target, with the promotions, double push or capture flag it needs
+  void add_pawn_move(int start, int target, MoveList &moves, GenType type) const;
+  // add a move from start to every target, capture flag is set when the target is occupied
+  void add_moves(int start, u_long64_t targets, MoveList &moves) const;
+  // add legal moves of the pawn on a square, allowed is the mask of squares the pawn can move to
+  // because of checks and pins
+  template<int Us, Attacks::SliderBackend B>
+  void add_legal_pawn_moves(int square, u_long64_t allowed, int king_square, MoveList &moves, GenType type) const;
+  // push and capture targets of the pawn on a square limited to allowed, without en passant
+  template<int Us>
+  u_long64_t legal_pawn_targets(int square, u_long64_t allowed) const;
+  // true if the pawn on a square can capture en passant without leaving its king in check
+  template<int Us, Attacks::SliderBackend B>
+  bool is_en_passant_legal(int square, int king_square) const;
+  // add castles that are allowed by castling rights, empty squares and the attacked squares
+  template<int Us>
+  void add_castling_moves(int king_square, u_long64_t attacked, MoveList &moves) const;
+  // bitboard of the squares the king lands on for every allowed castle
+  template<int Us>
+  u_long64_t castling_targets(int king_square, u_long64_t attacked) const;
+
+  // the generators and attack queries of one slider backend, the arrays are indexed by Piece::colour_index
+  struct SliderFunctions {
+    Attacks::SliderBackend backend;
+    void (Position::*generate_legal_moves[2])(MoveList &moves, GenType type) const;
+    int (Position::*count_legal_moves[2])() const;
+    u_long64_t (Position::*attacked_squares[2])(u_long64_t occupancy) const;
+    u_long64_t (Position::*pinned_pieces[2])() const;
+    u_long64_t (Position::*attackers_to)(int square, u_long64_t occupancy) const;
+  };
+  template<Attacks::SliderBackend B>
+  static constexpr SliderFunctions slider_functions_for();
+  static const SliderFunctions MAGIC_FUNCTIONS;
+  static const SliderFunctions PEXT_FUNCTIONS;
+  // set once at startup from Attacks::cpu_has_fast_pext, changed only by set_slider_backend
+  static const SliderFunctions *slider_functions;
+
+  static const char WHITE_QUEENSIDE_SQUARES[2];
+  static const char WHITE_KINGSIDE_SQUARES[2];
+  static const char BLACK_QUEENSIDE_SQUARES[2];
+  static const char BLACK_KINGSIDE_SQUARES[2];
+
+  static const char NO_EN_PASSANT = -1;
+};
+
+static_assert(std::is_trivially_copyable<Position>::value, "Position is copied with copy-make");
@@ -0,0 +1,45 @@
+#include "Position.h"
+
+#pragma once
+
+/**
+ * @brief Yields the legal moves of a position in stages: first the tactical moves (captures and promotions), then the quiet moves.
+ *
+ * Every stage is generated only when the moves of the previous one were used up, so a search that
+ * stops after a capture (e.g. on a beta cutoff) never pays for generating the quiet moves.
+ *
+ * \b Example:
+ * StagedMoveGenerator generator(position);
+ * PackedMove move;
+ * while(generator.next(move)) { position.make_move(move, child); ... }
+ */
+class StagedMoveGenerator {
+public:
+  enum class Stage {
+    Tactical,
+    Quiet,
+    Done
+  };
+
+  /**
+   * @param position Position to generate the moves of, it must not change while the generator is used.
+  */
+  explicit StagedMoveGenerator(const Position &position);
+
+  /**
+   * @brief Get the next legal move.
+   *
+   * @param move Set to the next move when there is one.
+   * @return false when all moves were returned.
+  */
+  bool next(PackedMove &move);
+
+  // stage of the move returned last
+  Stage stage() const { return current_stage; }
+
+private:
+  const Position &position;
+  Stage current_stage;
+  MoveList moves;
+  int index;
+};
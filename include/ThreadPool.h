@@ -0,0 +1,67 @@
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#pragma once
+
+/**
+ * @brief A pool of worker threads with one task queue per worker and work stealing.
+ *
+ * Submitted tasks are spread over the worker queues. A worker takes tasks from the back of its own queue,
+ * when it is empty it steals from the front of the other queues, so no worker sits idle while work is left.
+ * Every task gets the index of the worker running it, which can be used to give each worker its own data.
+ *
+ * \b Example:
+ * ThreadPool pool(4);
+ * pool.submit([](int worker) { ... });
+ * pool.wait();
+ */
+class ThreadPool {
+public:
+  /**
+   * @param threads Number of worker threads, at least one is created.
+  */
+  explicit ThreadPool(int threads);
+  ~ThreadPool();
+
+  ThreadPool(const ThreadPool &) = delete;
+  ThreadPool &operator=(const ThreadPool &) = delete;
+
+  void submit(std::function<void(int)> task);
+
+  // blocks until every submitted task has finished
+  void wait();
+
+  int size() const { return (int)workers.size(); }
+
+private:
+  struct WorkerQueue {
+    std::mutex mutex;
+    std::deque<std::function<void(int)>> tasks;
+    // tasks.size(), changed under mutex, read without it to skip empty queues
+    std::atomic<int> size{0};
+  };
+
+  void worker_loop(int worker);
+  // take a task from the own queue or steal one, returns false if every queue is empty
+  bool pop_task(int worker, std::function<void(int)> &task);
+
+  std::vector<std::unique_ptr<WorkerQueue>> queues;
+  std::vector<std::thread> workers;
+
+  // only used to sleep and wake up, tasks are pushed and popped under the mutex of their queue
+  std::mutex state_mutex;
+  std::condition_variable work_available;
+  std::condition_variable all_done;
+  // tasks sitting in the queues, raised under state_mutex so that waking up is not missed
+  std::atomic<int> queued{0};
+  // tasks submitted and not finished yet
+  std::atomic<int> pending{0};
+  bool stopping = false;
+  std::atomic<unsigned> next_queue{0};
+};
@@ -0,0 +1,65 @@
+#include "ChessConstants.h"
+
+#pragma once
+
+/**
+ * @brief Random keys used to hash a position into a single 64 bit number (Zobrist hashing).
+ *
+ * The key of a position is the xor of the keys of every piece on its square, the side to move key when black is to move,
+ * the key of the castling rights and the key of the en passant file when there is an en passant target.
+ * Because xor is its own inverse, GameState::make_move only has to xor the keys that changed.
+ *
+ * The keys are generated at compile time with a fixed seed, so keys are the same in every build.
+ */
+namespace Zobrist {
+  struct Keys {
+    // indexed by the piece (type | colour) and the square
+    u_long64_t pieces[24][64];
+    u_long64_t black_to_move;
+    // indexed by the castling rights bitmask
+    u_long64_t castling[16];
+    u_long64_t en_passant_file[8];
+  };
+
+  // splitmix64 pseudo random number generator
+  constexpr u_long64_t next_random(u_long64_t &state) {
+    state += 0x9E3779B97F4A7C15ULL;
+    u_long64_t z = state;
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+    return z ^ (z >> 31);
+  }
+
+  constexpr Keys generate_keys() {
+    Keys keys = {};
+    u_long64_t state = 0x5EED;
+    for(int piece = 0; piece < 24; piece++) {
+      for(int square = 0; square < 64; square++) {
+        keys.pieces[piece][square] = next_random(state);
+      }
+    }
+    keys.black_to_move = next_random(state);
+    for(int i = 0; i < 16; i++) {
+      keys.castling[i] = next_random(state);
+    }
+    for(int i = 0; i < 8; i++) {
+      keys.en_passant_file[i] = next_random(state);
+    }
+    return keys;
+  }
+
+  inline constexpr Keys keys = generate_keys();
+
+  inline u_long64_t piece(int piece, int square) {
+    return keys.pieces[piece][square];
+  }
+
+  inline u_long64_t castling(int castling_rights) {
+    return keys.castling[castling_rights];
+  }
+
+  // en passant target square to the key of its file
+  inline u_long64_t en_passant(int en_passant_square) {
+    return keys.en_passant_file[en_passant_square % 8];
+  }
+};
@@ -1,9 +1,10 @@
-#include "FenParser.h"
-#include "GameState.h"
 #include <fstream>
 #include <iostream>
 #include <sstream>
+#include <iomanip>
 #include "ChessConstants.h"
+#include "Attacks.h"
+#include <random>
 
 typedef unsigned long long int u_long64_t;
 
@@ -17,70 +18,85 @@ typedef unsigned long long int u_long64_t;
 // 40 41 42 43 44 45 46 47
 // 48 49 50 51 52 53 54 55
 // 56 57 58 59 60 61 62 63
-std::string int_to_bin_string(u_long64_t n) {
-    std::string result = "";
-    while (n > 0) {
-        result = (n % 2 == 0 ? "0" : "1") + result;
-        n /= 2;
-    }
-    if(result.size() < 64){
-        result = std::string(64 - result.size(), '0') + result;
-    }
-    return "0b" + result;
+std::string int_to_hex_string(u_long64_t n) {
+    std::stringstream ss;
+    ss << "0x" << std::hex << std::setw(16) << std::setfill('0') << std::uppercase << n << "ULL";
+    return ss.str();
 }
 
-void append_to_file(std::vector<u_long64_t> &lookup_table, std::string name) {
-    std::ofstream file("../lookup.txt", std::ios::app);
-    file << "const u_long64_t " << name << "[64] = {" << std::endl;
-    for (auto &entry : lookup_table) {
-        file << int_to_bin_string(entry) << "," << std::endl;
+// the attack tables are computed at compile time (AttackTables.h), only the magic numbers
+// have to be searched for, they are written to magics.txt to be pasted into ChessConstants.h
+void append_magics_to_file(std::vector<u_long64_t> &magics, std::string name) {
+    std::ofstream file("../magics.txt", std::ios::app);
+    file << "inline constexpr u_long64_t " << name << "[64] = {" << std::endl;
+    for (auto &magic : magics) {
+        file << int_to_hex_string(magic) << "," << std::endl;
     }
     file << "};\n" << std::endl;
     file.close();
 }
 
+// Find a magic number for a square by trial and error.
+// A magic is valid when every subset of the mask multiplied by it and shifted right
+// by 64 - popcount(mask) lands on an index that holds the same attacks (or is still empty).
+u_long64_t find_magic(int square, u_long64_t mask, u_long64_t (*reference_attacks)(int, u_long64_t), std::mt19937_64 &rng) {
+    int bits = __builtin_popcountll(mask);
+    int shift = 64 - bits;
+
+    std::vector<u_long64_t> occupancies;
+    std::vector<u_long64_t> attacks;
+    u_long64_t occupancy = 0;
+    do {
+        occupancies.push_back(occupancy);
+        attacks.push_back(reference_attacks(square, occupancy));
+        occupancy = (occupancy - mask) & mask;
+    } while (occupancy != 0);
+
+    std::vector<u_long64_t> table(1ULL << bits);
+    std::vector<int> used(1ULL << bits);
+    for (int attempt = 1; ; attempt++) {
+        // numbers with few set bits work best
+        u_long64_t magic = rng() & rng() & rng();
+        // the top byte of the product decides the index, it has to contain enough bits of the mask
+        if (__builtin_popcountll((mask * magic) & 0xFF00000000000000ULL) < 6) {
+            continue;
+        }
+
+        bool failed = false;
+        for (int i = 0; i < (int)occupancies.size() && !failed; i++) {
+            int index = (int)((occupancies[i] * magic) >> shift);
+            if (used[index] != attempt) {
+                used[index] = attempt;
+                table[index] = attacks[i];
+            } else if (table[index] != attacks[i]) {
+                failed = true;
+            }
+        }
+
+        if (!failed) {
+            return magic;
+        }
+    }
+}
+
 int main() {
-    std::ofstream file("../lookup.txt");
+    std::ofstream file("../magics.txt");
     file.clear();
     file.close();
-    GameState game = FenParser::parse_fen(STARTING_FEN);
-    game.board.fill(0);
-    std::string input;
-    // for horsies
-    std::vector<u_long64_t> knight_lookup(64, 0);
-    for(int i = 0; i < 64; i++){
-        game.board[i] = Piece::Knight | Piece::White;
-        std::vector<Move> moves = game.generate_knight_moves(i);
-        for(auto &move : moves){
-            knight_lookup[i] |= (1ULL << move.end);
-        }
-        game.board[i] = 0;
-    }
-    append_to_file(knight_lookup, "knight_lookup");
 
-    // for bishops
-    std::vector<u_long64_t> bishop_lookup(64, 0);
+    // magic numbers, fixed seed so that the output is reproducible
+    std::mt19937_64 rng(20231001);
+    std::vector<u_long64_t> rook_magic_numbers(64, 0);
     for(int i = 0; i < 64; i++){
-        game.board[i] = Piece::Bishop | Piece::White;
-        std::vector<Move> moves = game.generate_diagonal_sliding_moves(i);
-        for(auto &move : moves){
-            bishop_lookup[i] |= (1ULL << move.end);
-        }
-        game.board[i] = 0;
+        rook_magic_numbers[i] = find_magic(i, Attacks::rook_mask(i), Attacks::reference_rook_attacks, rng);
     }
-    append_to_file(bishop_lookup, "bishop_lookup");
+    append_magics_to_file(rook_magic_numbers, "rook_magic_numbers");
 
-    // for rooks
-    std::vector<u_long64_t> rook_lookup(64, 0);
+    std::vector<u_long64_t> bishop_magic_numbers(64, 0);
     for(int i = 0; i < 64; i++){
-        game.board[i] = Piece::Rook | Piece::White;
-        std::vector<Move> moves = game.generate_straight_sliding_moves(i);
-        for(auto &move : moves){
-            rook_lookup[i] |= (1ULL << move.end);
-        }
-        game.board[i] = 0;
+        bishop_magic_numbers[i] = find_magic(i, Attacks::bishop_mask(i), Attacks::reference_bishop_attacks, rng);
     }
-    append_to_file(rook_lookup, "rook_lookup");
+    append_magics_to_file(bishop_magic_numbers, "bishop_magic_numbers");
 
     return 0;
-}
\ No newline at end of file
+}
@@ -0,0 +1,83 @@
+#include "FenParser.h"
+#include "GameState.h"
+#include "ChessConstants.h"
+#include "Perft.h"
+#include <chrono>
+#include <iostream>
+#include <string>
+
+// Command line perft, prints the node count of every root move (divide),
+// the total number of nodes, the time it took and nodes per second.
+//
+// usage: ./perft "<fen>|startpos" <depth> [threads] [hash_mb]
+// example: ./perft startpos 6 8 256
+
+void print_usage() {
+    std::cerr << "usage: perft \"<fen>|startpos\" <depth> [threads] [hash_mb]" << std::endl;
+    std::cerr << "  threads  number of threads, 1 by default" << std::endl;
+    std::cerr << "  hash_mb  size of the transposition table in MB, 0 (no table) by default" << std::endl;
+}
+
+int main(int argc, char *argv[]) {
+    if (argc < 3 || argc > 5) {
+        print_usage();
+        return 1;
+    }
+
+    std::string fen = argv[1];
+    if (fen == "startpos") {
+        fen = STARTING_FEN;
+    }
+
+    int depth, threads = 1, hash_mb = 0;
+    try {
+        depth = std::stoi(argv[2]);
+        if (argc > 3) {
+            threads = std::stoi(argv[3]);
+        }
+        if (argc > 4) {
+            hash_mb = std::stoi(argv[4]);
+        }
+    } catch (std::exception &e) {
+        print_usage();
+        return 1;
+    }
+
+    if (depth < 1 || threads < 1 || hash_mb < 0) {
+        print_usage();
+        return 1;
+    }
+
+    GameState game;
+    try {
+        game = FenParser::parse_fen(fen);
+    } catch (std::exception &e) {
+        std::cerr << e.what() << std::endl;
+        return 1;
+    }
+
+    std::unique_ptr<PerftTable> table;
+    if (hash_mb > 0) {
+        table = std::make_unique<PerftTable>(hash_mb);
+    }
+
+    auto start = std::chrono::steady_clock::now();
+    std::map<std::string, u_long64_t> divide = threads == 1
+        ? Perft::divide(game.position(), depth, table.get())
+        : Perft::parallel_divide(game.position(), depth, threads, 2, table.get());
+    auto end = std::chrono::steady_clock::now();
+
+    u_long64_t nodes = 0;
+    for (auto &move : divide) {
+        std::cout << move.first << " " << move.second << std::endl;
+        nodes += move.second;
+    }
+
+    double seconds = std::chrono::duration<double>(end - start).count();
+    std::cout << std::endl;
+    std::cout << "Nodes: " << nodes << std::endl;
+    std::cout << "Time: " << (u_long64_t)(seconds * 1000) << " ms" << std::endl;
+    std::cout << "NPS: " << (u_long64_t)(seconds > 0 ? nodes / seconds : 0) << std::endl;
+
+    return 0;
+}
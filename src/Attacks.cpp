@@ -0,0 +1,54 @@
+#include "Attacks.h"
+
+#if ATTACKS_HAS_PEXT
+#include <cpuid.h>
+#endif
+
+namespace AttackTables {
+  constexpr SquareTable knight = generate_step_attacks(KNIGHT_STEPS);
+  constexpr SquareTable king = generate_step_attacks(KING_STEPS);
+  constexpr PawnTable pawn = generate_pawn_attacks();
+  constexpr SquarePairTable between = generate_square_pairs(false);
+  constexpr SquarePairTable line = generate_square_pairs(true);
+  constexpr RayTable rays = generate_rays();
+  constexpr SliderTable<ROOK_TABLE_SIZE> rook =
+    generate_slider_table<ROOK_TABLE_SIZE>(rays, 0, ChessConstants::rook_magic_numbers, rook_mask);
+  constexpr SliderTable<BISHOP_TABLE_SIZE> bishop =
+    generate_slider_table<BISHOP_TABLE_SIZE>(rays, 4, ChessConstants::bishop_magic_numbers, bishop_mask);
+}
+
+bool Attacks::cpu_has_pext() {
+#if ATTACKS_HAS_PEXT
+  __builtin_cpu_init();
+  return __builtin_cpu_supports("bmi2");
+#else
+  return false;
+#endif
+}
+
+bool Attacks::cpu_has_fast_pext() {
+#if ATTACKS_HAS_PEXT
+  if(!cpu_has_pext()) {
+    return false;
+  }
+
+  // AMD before Zen 3 (family 0x17) implements pext in microcode
+  unsigned int eax, ebx, ecx, edx;
+  if(__get_cpuid(0, &eax, &ebx, &ecx, &edx)) {
+    // "AuthenticAMD" is stored in ebx, edx, ecx
+    bool is_amd = ebx == 0x68747541 && edx == 0x69746e65 && ecx == 0x444d4163;
+    if(is_amd && __get_cpuid(1, &eax, &ebx, &ecx, &edx)) {
+      unsigned int family = (eax >> 8) & 0xF;
+      if(family == 0xF) {
+        family += (eax >> 20) & 0xFF;
+      }
+      if(family == 0x17) {
+        return false;
+      }
+    }
+  }
+  return true;
+#else
+  return false;
+#endif
+}
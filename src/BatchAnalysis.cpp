@@ -0,0 +1,192 @@
+#include "BatchAnalysis.h"
+#include "FenParser.h"
+#include "ThreadPool.h"
+#include <charconv>
+#include <cerrno>
+#include <cstdint>
+#include <cstring>
+#include <fcntl.h>
+#include <stdexcept>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <vector>
+
+MappedFile::MappedFile(const std::string &path) {
+  int fd = open(path.c_str(), O_RDONLY);
+  if(fd < 0) {
+    throw std::runtime_error("Can not open " + path + ": " + std::strerror(errno));
+  }
+
+  struct stat file_stat;
+  if(fstat(fd, &file_stat) != 0) {
+    close(fd);
+    throw std::runtime_error("Can not read the size of " + path + ": " + std::strerror(errno));
+  }
+
+  size = (size_t)file_stat.st_size;
+  if(size > 0) {
+    void *mapping = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+    if(mapping == MAP_FAILED) {
+      close(fd);
+      throw std::runtime_error("Can not map " + path + ": " + std::strerror(errno));
+    }
+    // the lines are read once from start to end
+    madvise(mapping, size, MADV_SEQUENTIAL);
+    data = (const char *)mapping;
+  }
+  // the mapping stays valid after the descriptor is closed
+  close(fd);
+}
+
+MappedFile::~MappedFile() {
+  if(data != nullptr) {
+    munmap((void *)data, size);
+  }
+}
+
+namespace {
+  void append_square(std::string &out, int square) {
+    out += (char)('a' + square % 8);
+    out += (char)('8' - square / 8);
+  }
+
+  // coordinate notation, e2e4, e7e8q, castles are written as the king move e1g1
+  void append_move(std::string &out, PackedMove move) {
+    append_square(out, move.start());
+    append_square(out, move.end());
+    if(move.is_promotion()) {
+      // indexed by the lowest two bits of the promotion kind
+      out += "nbrq"[move.kind() & 3];
+    }
+  }
+
+  template<typename T>
+  void append_binary(std::string &out, T value) {
+    out.append((const char *)&value, sizeof(T));
+  }
+
+  void append_result(std::string &out, const GameState &game, MoveList &moves, const BatchAnalysis::Options &options) {
+    if(options.mode == BatchAnalysis::Mode::Count) {
+      int count = game.count_legal_moves();
+      if(options.format == BatchAnalysis::Format::Binary) {
+        append_binary<int32_t>(out, count);
+      } else {
+        char digits[16];
+        char *end = std::to_chars(digits, digits + sizeof(digits), count).ptr;
+        out.append(digits, end);
+        out += '\n';
+      }
+      return;
+    }
+
+    moves.clear();
+    game.generate_legal_moves(game.turn, moves);
+    if(options.format == BatchAnalysis::Format::Binary) {
+      append_binary<uint16_t>(out, (uint16_t)moves.size());
+      for(PackedMove move : moves) {
+        append_binary<uint16_t>(out, move.data);
+      }
+    } else {
+      for(int i = 0; i < moves.size(); i++) {
+        if(i > 0) {
+          out += ' ';
+        }
+        append_move(out, moves[i]);
+      }
+      out += '\n';
+    }
+  }
+
+  void append_error(std::string &out, const char *reason, const BatchAnalysis::Options &options) {
+    if(options.format == BatchAnalysis::Format::Binary) {
+      if(options.mode == BatchAnalysis::Mode::Count) {
+        append_binary<int32_t>(out, -1);
+      } else {
+        append_binary<uint16_t>(out, 0xFFFF);
+      }
+    } else {
+      out += "error: ";
+      out += reason;
+      out += '\n';
+    }
+  }
+
+  // end of the chunk starting at start, at least chunk_bytes long unless the input ends, cut after a newline
+  size_t chunk_end(std::string_view input, size_t start, size_t chunk_bytes) {
+    if(input.size() - start <= chunk_bytes) {
+      return input.size();
+    }
+    size_t newline = input.find('\n', start + chunk_bytes);
+    return newline == std::string_view::npos ? input.size() : newline + 1;
+  }
+}
+
+size_t BatchAnalysis::analyse_chunk(std::string_view chunk, GameState &game, std::string &out, const Options &options) {
+  MoveList moves;
+  size_t positions = 0;
+  while(!chunk.empty()) {
+    size_t newline = chunk.find('\n');
+    std::string_view line = chunk.substr(0, newline);
+    chunk.remove_prefix(newline == std::string_view::npos ? chunk.size() : newline + 1);
+
+    if(line.find_first_not_of(" \t\r") == std::string_view::npos) {
+      continue;
+    }
+
+    positions++;
+    FenError error = FenParser::parse_fen(line, game);
+    if(error != FenError::None) {
+      append_error(out, FenParser::error_message(error), options);
+    } else {
+      append_result(out, game, moves, options);
+    }
+  }
+  return positions;
+}
+
+size_t BatchAnalysis::run(std::string_view input, std::ostream &out, const Options &options) {
+  size_t chunk_bytes = options.chunk_bytes > 0 ? options.chunk_bytes : 1;
+  std::vector<GameState> games(options.threads > 1 ? options.threads : 1);
+  size_t positions = 0;
+
+  if(options.threads <= 1) {
+    std::string buffer;
+    for(size_t start = 0; start < input.size(); ) {
+      size_t end = chunk_end(input, start, chunk_bytes);
+      buffer.clear();
+      positions += analyse_chunk(input.substr(start, end - start), games[0], buffer, options);
+      out.write(buffer.data(), (std::streamsize)buffer.size());
+      start = end;
+    }
+    return positions;
+  }
+
+  // a window of a few chunks per thread evens out chunks of different cost, after each window the output
+  // is written in order, so memory use does not grow with the input and the buffers are reused
+  ThreadPool pool(options.threads);
+  std::vector<std::string> buffers(options.threads * 4);
+  std::vector<size_t> counts(buffers.size());
+
+  for(size_t start = 0; start < input.size(); ) {
+    size_t chunks = 0;
+    for(; chunks < buffers.size() && start < input.size(); chunks++) {
+      size_t end = chunk_end(input, start, chunk_bytes);
+      std::string_view chunk = input.substr(start, end - start);
+      std::string &buffer = buffers[chunks];
+      size_t &count = counts[chunks];
+      pool.submit([chunk, &buffer, &count, &games, &options](int worker) {
+        buffer.clear();
+        count = analyse_chunk(chunk, games[worker], buffer, options);
+      });
+      start = end;
+    }
+    pool.wait();
+
+    for(size_t i = 0; i < chunks; i++) {
+      out.write(buffers[i].data(), (std::streamsize)buffers[i].size());
+      positions += counts[i];
+    }
+  }
+  return positions;
+}
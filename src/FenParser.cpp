@@ -1,120 +1,264 @@
 #include "FenParser.h"
 #include "ChessConstants.h"
 #include "GameState.h"
+#include <charconv>
+#include <stdexcept>
 #include <string>
-#include <vector>
-#include <sstream>
 
-std::array<int, 64> FenParser::parse_board(const std::string &board_string) {
-  std::array<int, 64> board;
-  int index = 0;
+namespace {
+  // the next space separated field of a line, removed from the front of line, empty at the end of the line
+  std::string_view next_field(std::string_view &line) {
+    size_t start = line.find_first_not_of(" \t\r\n");
+    if(start == std::string_view::npos) {
+      line = std::string_view();
+      return line;
+    }
+    size_t end = line.find_first_of(" \t\r\n", start);
+    if(end == std::string_view::npos) {
+      end = line.size();
+    }
+    std::string_view field = line.substr(start, end - start);
+    line.remove_prefix(end);
+    return field;
+  }
 
-  board.fill(0);
+  bool parse_number(std::string_view field, int &number) {
+    auto result = std::from_chars(field.data(), field.data() + field.size(), number);
+    return !field.empty() && result.ec == std::errc() && result.ptr == field.data() + field.size() && number >= 0;
+  }
 
-  for(char c : board_string) {
-    if(c == '/') {
-      continue;
+  int piece_from_char(char c) {
+    switch(c) {
+      case 'p': return Piece::Black | Piece::Pawn;
+      case 'n': return Piece::Black | Piece::Knight;
+      case 'b': return Piece::Black | Piece::Bishop;
+      case 'r': return Piece::Black | Piece::Rook;
+      case 'q': return Piece::Black | Piece::Queen;
+      case 'k': return Piece::Black | Piece::King;
+      case 'P': return Piece::White | Piece::Pawn;
+      case 'N': return Piece::White | Piece::Knight;
+      case 'B': return Piece::White | Piece::Bishop;
+      case 'R': return Piece::White | Piece::Rook;
+      case 'Q': return Piece::White | Piece::Queen;
+      case 'K': return Piece::White | Piece::King;
+      default: return Piece::NonePiece;
     }
+  }
 
-    if(c >= '1' && c <= '8') {
-      index += c - '0';
-    } else {
-      int piece = Piece::NonePiece;
-
+  FenError parse_castling_rights(std::string_view field, char &castling_rights) {
+    castling_rights = 0;
+    if(field == "-") {
+      return FenError::None;
+    }
+    for(char c : field) {
       switch(c) {
-        case 'p':
-          piece = Piece::Black | Piece::Pawn;
-          break;
-        case 'n':
-          piece = Piece::Black | Piece::Knight;
-          break;
-        case 'b':
-          piece = Piece::Black | Piece::Bishop;
-          break;
-        case 'r':
-          piece = Piece::Black | Piece::Rook;
+        case 'K':
+          castling_rights |= WHITE_KING_SIDE;
           break;
-        case 'q':
-          piece = Piece::Black | Piece::Queen;
+        case 'Q':
+          castling_rights |= WHITE_QUEEN_SIDE;
           break;
         case 'k':
-          piece = Piece::Black | Piece::King;
+          castling_rights |= BLACK_KING_SIDE;
           break;
-        case 'P':
-          piece = Piece::White | Piece::Pawn;
-          break;
-        case 'N':
-          piece = Piece::White | Piece::Knight;
-          break;
-        case 'B':
-          piece = Piece::White | Piece::Bishop;
-          break;
-        case 'R':
-          piece = Piece::White | Piece::Rook;
-          break;
-        case 'Q':
-          piece = Piece::White | Piece::Queen;
-          break;
-        case 'K':
-          piece = Piece::White | Piece::King;
+        case 'q':
+          castling_rights |= BLACK_QUEEN_SIDE;
           break;
         default:
-          throw std::invalid_argument("Invalid FEN string, unknown piece");
+          return FenError::CastlingRights;
+      }
+    }
+    return field.empty() ? FenError::CastlingRights : FenError::None;
+  }
+
+  // the move generator trusts the position, so everything it relies on is checked:
+  // one king of each colour, no pawns on the first or last rank, material that keeps the number of moves
+  // within MoveList::CAPACITY, the king and rook of every castling right on their squares, a pawn that can
+  // have just moved two squares behind the en passant square and no check on the side that just moved
+  FenError validate_position(const std::array<int, 64> &board, int turn, char castling_rights, char en_passant_square) {
+    int white_kings = 0, black_kings = 0;
+    int king_squares[2] = {-1, -1};
+    for(int i = 0; i < 64; i++) {
+      white_kings += board[i] == (Piece::White | Piece::King);
+      black_kings += board[i] == (Piece::Black | Piece::King);
+      if(Piece::piece_type(board[i]) == Piece::King) {
+        king_squares[Piece::colour_index(board[i])] = i;
+      }
+      if(Piece::piece_type(board[i]) == Piece::Pawn && (i < 8 || i >= 56)) {
+        return FenError::PawnOnBackRank;
+      }
+    }
+    if(white_kings != 1 || black_kings != 1) {
+      return FenError::KingCount;
+    }
+    if(!Position::is_possible_material(board)) {
+      return FenError::Material;
+    }
+
+    const int white_king = Piece::White | Piece::King, white_rook = Piece::White | Piece::Rook;
+    const int black_king = Piece::Black | Piece::King, black_rook = Piece::Black | Piece::Rook;
+    if(((castling_rights & WHITE_KING_SIDE) && (board[60] != white_king || board[63] != white_rook))
+      || ((castling_rights & WHITE_QUEEN_SIDE) && (board[60] != white_king || board[56] != white_rook))
+      || ((castling_rights & BLACK_KING_SIDE) && (board[4] != black_king || board[7] != black_rook))
+      || ((castling_rights & BLACK_QUEEN_SIDE) && (board[4] != black_king || board[0] != black_rook))) {
+      return FenError::CastlingRights;
+    }
+
+    if(en_passant_square != -1) {
+      // white to move captures on the 6th rank a black pawn standing below it, and the other way round
+      int pushed_pawn = turn == Piece::White ? en_passant_square + 8 : en_passant_square - 8;
+      int pawn = (turn == Piece::White ? Piece::Black : Piece::White) | Piece::Pawn;
+      bool on_rank = turn == Piece::White ? (en_passant_square >= 16 && en_passant_square < 24)
+                                          : (en_passant_square >= 40 && en_passant_square < 48);
+      if(!on_rank || board[en_passant_square] != Piece::NonePiece || board[pushed_pawn] != pawn) {
+        return FenError::EnPassantSquare;
       }
+    }
 
-      board[index] = piece;
-      index++;
+    // a Position is trivially copyable, filling one on the stack costs nothing and allows the attack check
+    Position position;
+    position.board = board;
+    position.init_bitboards();
+    int opponent = turn == Piece::White ? Piece::Black : Piece::White;
+    if(position.is_square_attacked(king_squares[Piece::colour_index(opponent)], opponent)) {
+      return FenError::OpponentInCheck;
     }
+    return FenError::None;
   }
+}
+
+const char *FenParser::error_message(FenError error) noexcept {
+  switch(error) {
+    case FenError::None:
+      return "No error";
+    case FenError::MissingFields:
+      return "Invalid FEN string, expected at least 4 space separated tokens";
+    case FenError::UnknownPiece:
+      return "Invalid FEN string, unknown piece";
+    case FenError::BoardSize:
+      return "Invalid FEN string, the board needs 8 ranks of 8 squares";
+    case FenError::KingCount:
+      return "Invalid board, there has to be one king of each colour";
+    case FenError::PawnOnBackRank:
+      return "Invalid board, pawn on the first or last rank";
+    case FenError::Material:
+      return "Invalid board, more pawns or promoted pieces than a game can have";
+    case FenError::OpponentInCheck:
+      return "Invalid position, the side that is not to move is in check";
+    case FenError::SideToMove:
+      return "Invalid FEN string, unknown side to move";
+    case FenError::CastlingRights:
+      return "Invalid FEN string, unknown castling rights or the king or rook is not on its square";
+    case FenError::EnPassantSquare:
+      return "Invalid FEN string, invalid en passant square";
+    case FenError::Clocks:
+      return "Invalid FEN string, invalid halfmove clock or fullmove counter";
+  }
+  return "Unknown error";
+}
+
+FenError FenParser::parse_board(std::string_view board_string, std::array<int, 64> &board) noexcept {
+  board.fill((int)Piece::NonePiece);
+  int rank = 0;
+  int file = 0;
 
+  for(char c : board_string) {
+    if(c == '/') {
+      if(file != 8 || rank == 7) {
+        return FenError::BoardSize;
+      }
+      rank++;
+      file = 0;
+    } else if(c >= '1' && c <= '8') {
+      file += c - '0';
+      if(file > 8) {
+        return FenError::BoardSize;
+      }
+    } else {
+      int piece = piece_from_char(c);
+      if(piece == Piece::NonePiece) {
+        return FenError::UnknownPiece;
+      }
+      if(file >= 8) {
+        return FenError::BoardSize;
+      }
+      board[rank * 8 + file] = piece;
+      file++;
+    }
+  }
+
+  return rank == 7 && file == 8 ? FenError::None : FenError::BoardSize;
+}
+
+std::array<int, 64> FenParser::parse_board(std::string_view board_string) {
+  std::array<int, 64> board;
+  FenError error = parse_board(board_string, board);
+  if(error != FenError::None) {
+    throw std::invalid_argument(error_message(error));
+  }
   return board;
-};
+}
 
 GameState FenParser::parse_fen(const std::string &fen_string) {
-  // split the fen into tokens
-  std::vector<std::string> tokens;
-  std::string token;
-  std::stringstream fen_stream(fen_string);
-  
-  while(std::getline(fen_stream, token, ' ')) {
-    tokens.push_back(token);
+  GameState game;
+  FenError error = parse_fen(std::string_view(fen_string), game);
+  if(error != FenError::None) {
+    throw std::invalid_argument(error_message(error));
   }
+  return game;
+}
 
-  if(tokens.size() != 6) {
-    throw std::invalid_argument("Invalid FEN string, expected 6 space separated tokens");
+FenError FenParser::parse_fen(std::string_view fen_string, GameState &game) noexcept {
+  std::string_view board_field = next_field(fen_string);
+  std::string_view turn_field = next_field(fen_string);
+  std::string_view castling_field = next_field(fen_string);
+  std::string_view en_passant_field = next_field(fen_string);
+
+  if(en_passant_field.empty()) {
+    return FenError::MissingFields;
   }
 
-  std::array<int, 64> board = FenParser::parse_board(tokens[0]);
+  std::array<int, 64> board;
+  FenError error = parse_board(board_field, board);
+  if(error != FenError::None) {
+    return error;
+  }
 
-  int color = tokens[1] == "w" ? Piece::White : Piece::Black;
+  if(turn_field != "w" && turn_field != "b") {
+    return FenError::SideToMove;
+  }
+  int turn = turn_field == "w" ? Piece::White : Piece::Black;
 
-  char castling_rights = 0;
-  for(char c : tokens[2]) {
-    switch(c) {
-      case 'K':
-        castling_rights |= WHITE_KING_SIDE;
-        break;
-      case 'Q':
-        castling_rights |= WHITE_QUEEN_SIDE;
-        break;
-      case 'k':
-        castling_rights |= BLACK_KING_SIDE;
-        break;
-      case 'q':
-        castling_rights |= BLACK_QUEEN_SIDE;
-        break;
-      case '-':
-        break;
-      default:
-        throw std::invalid_argument("Invalid FEN string, unknown castling rights");
+  char castling_rights;
+  error = parse_castling_rights(castling_field, castling_rights);
+  if(error != FenError::None) {
+    return error;
+  }
+
+  char en_passant_square = -1;
+  if(en_passant_field != "-") {
+    if(en_passant_field.size() != 2 || en_passant_field[0] < 'a' || en_passant_field[0] > 'h'
+      || en_passant_field[1] < '1' || en_passant_field[1] > '8') {
+      return FenError::EnPassantSquare;
     }
+    en_passant_square = (en_passant_field[0] - 'a') + (8 - (en_passant_field[1] - '0')) * 8;
   }
 
-  char en_passant_square = tokens[3] == "-" ? -1 : (tokens[3][0] - 'a') + (8 - (tokens[3][1] - '0')) * 8;
+  // a FEN ends with the two clocks, in an EPD the operations follow instead, they start with a letter
+  int halfmove_clock = 0;
+  int fullmove_counter = 1;
+  std::string_view halfmove_field = next_field(fen_string);
+  if(!halfmove_field.empty() && halfmove_field[0] >= '0' && halfmove_field[0] <= '9') {
+    if(!parse_number(halfmove_field, halfmove_clock) || !parse_number(next_field(fen_string), fullmove_counter)) {
+      return FenError::Clocks;
+    }
+  }
 
-  int halfmove_clock = std::stoi(tokens[4]);
+  error = validate_position(board, turn, castling_rights, en_passant_square);
+  if(error != FenError::None) {
+    return error;
+  }
 
-  int fullmove_counter = std::stoi(tokens[5]);
-  
-  return GameState(board, color, castling_rights, en_passant_square, halfmove_clock, fullmove_counter);
+  game.set_position(board, turn, castling_rights, en_passant_square, halfmove_clock, fullmove_counter);
+  return FenError::None;
 }
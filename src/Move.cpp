@@ -127,6 +127,42 @@ std::array<int, 4> Move::parse_lan(const std::string &lan_str) {
   return {start_square, end_square, piece, flags};
 }
 
+bool Move::parse_uci(std::string_view uci_str, int &start, int &end, int &promotion) noexcept {
+  if(uci_str.size() != 4 && uci_str.size() != 5) {
+    return false;
+  }
+
+  // squares are counted from a8, like the board
+  for(int i = 0; i < 4; i += 2) {
+    if(uci_str[i] < 'a' || uci_str[i] > 'h' || uci_str[i + 1] < '1' || uci_str[i + 1] > '8') {
+      return false;
+    }
+  }
+  start = (uci_str[0] - 'a') + ('8' - uci_str[1]) * 8;
+  end = (uci_str[2] - 'a') + ('8' - uci_str[3]) * 8;
+
+  promotion = Piece::NonePiece;
+  if(uci_str.size() == 5) {
+    switch(uci_str[4]) {
+      case 'q':
+        promotion = Piece::Queen;
+        break;
+      case 'r':
+        promotion = Piece::Rook;
+        break;
+      case 'b':
+        promotion = Piece::Bishop;
+        break;
+      case 'n':
+        promotion = Piece::Knight;
+        break;
+      default:
+        return false;
+    }
+  }
+  return true;
+}
+
 // string used for perft testing
 // can be found in tests/PerftGenerationTest.cpp
 std::string Move::perft_str() const {
@@ -146,43 +182,6 @@ std::string Move::perft_str() const {
   return perft_str;
 }
 
-bool Move::is_normal(int flags) {
-  return (flags & NORMAL) == NORMAL;
-}
-bool Move::is_capture(int flags) {
-  return (flags & CAPTURE) == CAPTURE;
-}
-bool Move::is_en_passant(int flags) {
-  return (flags & EN_PASSANT) == EN_PASSANT;
-}
-bool Move::is_double_push(int flags) {
-  return (flags & DOUBLE_PUSH) == DOUBLE_PUSH;
-}
-bool Move::is_castle_kingside(int flags) {
-  return (flags & CASTLE_KINGSIDE) == CASTLE_KINGSIDE;
-}
-bool Move::is_castle_queenside(int flags) {
-  return (flags & CASTLE_QUEENSIDE) == CASTLE_QUEENSIDE;
-}
-bool Move::is_castle(int flags) {
-  return is_castle_kingside(flags) || is_castle_queenside(flags);
-}
-bool Move::is_promotion_queen(int flags) {
-  return (flags & PROMOTION_QUEEN) == PROMOTION_QUEEN;
-}
-bool Move::is_promotion_rook(int flags) {
-  return (flags & PROMOTION_ROOK) == PROMOTION_ROOK;
-}
-bool Move::is_promotion_bishop(int flags) {
-  return (flags & PROMOTION_BISHOP) == PROMOTION_BISHOP;
-}
-bool Move::is_promotion_knight(int flags) {
-  return (flags & PROMOTION_KNIGHT) == PROMOTION_KNIGHT;
-}
-bool Move::is_promotion(int flags) {
-  return is_promotion_queen(flags) || is_promotion_rook(flags) || is_promotion_bishop(flags) || is_promotion_knight(flags);
-}
-
 // overloaded operators
 std::ostream& operator<<(std::ostream &os, const Move &move) {
   if(Piece::colour(move.piece) == Piece::White){
@@ -194,12 +193,6 @@ std::ostream& operator<<(std::ostream &os, const Move &move) {
   return os;
 }
 
-bool Move::operator==(const Move &other) const {
-  return start == other.start && end == other.end && piece == other.piece && flags == other.flags;
-}
-bool Move::operator!=(const Move &other) const {
-  return !(*this == other);
-}
 bool Move::operator<(const Move &other) const {
   if (start < other.start) {
     return true;
@@ -218,4 +211,60 @@ bool Move::operator<(const Move &other) const {
 }
 bool Move::operator>(const Move &other) const {
   return !(*this < other || *this == other);
+}
+
+PackedMove::PackedMove(const Move &move) {
+  int kind = PackedMove::NORMAL;
+  if(Move::is_promotion(move.flags)) {
+    if(Move::is_promotion_queen(move.flags)) {
+      kind = PackedMove::PROMOTION_QUEEN;
+    } else if(Move::is_promotion_rook(move.flags)) {
+      kind = PackedMove::PROMOTION_ROOK;
+    } else if(Move::is_promotion_bishop(move.flags)) {
+      kind = PackedMove::PROMOTION_BISHOP;
+    } else {
+      kind = PackedMove::PROMOTION_KNIGHT;
+    }
+    if(Move::is_capture(move.flags)) {
+      kind |= PackedMove::CAPTURE;
+    }
+  } else if(Move::is_en_passant(move.flags)) {
+    kind = PackedMove::EN_PASSANT;
+  } else if(Move::is_capture(move.flags)) {
+    kind = PackedMove::CAPTURE;
+  } else if(Move::is_double_push(move.flags)) {
+    kind = PackedMove::DOUBLE_PUSH;
+  } else if(Move::is_castle_kingside(move.flags)) {
+    kind = PackedMove::CASTLE_KINGSIDE;
+  } else if(Move::is_castle_queenside(move.flags)) {
+    kind = PackedMove::CASTLE_QUEENSIDE;
+  }
+
+  data = (uint16_t)(move.start | (move.end << 6) | (kind << 12));
+}
+
+int PackedMove::flags() const {
+  // Move flags of every kind, indexed by kind
+  static const int KIND_FLAGS[16] = {
+    Move::NORMAL, Move::DOUBLE_PUSH, Move::CASTLE_KINGSIDE, Move::CASTLE_QUEENSIDE,
+    Move::CAPTURE, Move::EN_PASSANT, Move::NORMAL, Move::NORMAL,
+    Move::PROMOTION_KNIGHT, Move::PROMOTION_BISHOP, Move::PROMOTION_ROOK, Move::PROMOTION_QUEEN,
+    Move::PROMOTION_KNIGHT | Move::CAPTURE, Move::PROMOTION_BISHOP | Move::CAPTURE,
+    Move::PROMOTION_ROOK | Move::CAPTURE, Move::PROMOTION_QUEEN | Move::CAPTURE
+  };
+  return KIND_FLAGS[kind()];
+}
+
+Move PackedMove::to_move(int piece) const {
+  // both squares are 6 bits, always on the board
+  return Move(Move::UNCHECKED, start(), end(), piece, flags());
+}
+
+std::string PackedMove::lan_str(int piece) const {
+  return to_move(piece).lan_str();
+}
+
+std::string PackedMove::perft_str() const {
+  // perft strings do not depend on the piece
+  return to_move(Piece::NonePiece).perft_str();
 }
\ No newline at end of file
@@ -0,0 +1,165 @@
+#include "Perft.h"
+#include "ThreadPool.h"
+
+PerftTable::PerftTable(size_t size_mb) {
+  count = 1;
+  while(count * 2 * sizeof(Entry) <= size_mb * 1024 * 1024) {
+    count *= 2;
+  }
+  entries = std::make_unique<Entry[]>(count);
+  mask = count - 1;
+  clear();
+}
+
+// relaxed atomics compile to plain loads and stores, the xor check catches entries mixed from two writes
+bool PerftTable::probe(u_long64_t key, int depth, u_long64_t &nodes) const {
+  const Entry &entry = entries[key & mask];
+  u_long64_t data = entry.data.load(std::memory_order_relaxed);
+  u_long64_t entry_key = entry.key.load(std::memory_order_relaxed);
+  if((entry_key ^ data) != key || (int)(data & 0xFF) != depth) {
+    return false;
+  }
+  nodes = data >> 8;
+  return true;
+}
+
+void PerftTable::store(u_long64_t key, int depth, u_long64_t nodes) {
+  Entry &entry = entries[key & mask];
+  u_long64_t data = (nodes << 8) | (u_long64_t)depth;
+  entry.data.store(data, std::memory_order_relaxed);
+  entry.key.store(key ^ data, std::memory_order_relaxed);
+}
+
+void PerftTable::clear() {
+  // depth 0 is never stored, so zeroed entries never match
+  for(size_t i = 0; i < count; i++) {
+    entries[i].key.store(0, std::memory_order_relaxed);
+    entries[i].data.store(0, std::memory_order_relaxed);
+  }
+}
+
+namespace {
+  // a position split_ply moves below the root, reached from root move root_move
+  struct PerftTask {
+    int root_move;
+    Position position;
+  };
+
+  void collect_tasks(const Position &position, int plies_left, int root_move, std::vector<PerftTask> &tasks) {
+    if(plies_left == 0) {
+      tasks.push_back(PerftTask{root_move, position});
+      return;
+    }
+
+    MoveList moves;
+    position.generate_legal_moves(position.turn, moves);
+    Position child;
+    for(PackedMove move : moves) {
+      position.make_move(move, child);
+      collect_tasks(child, plies_left - 1, root_move, tasks);
+    }
+  }
+}
+
+// copy-make: every ply writes its children into a Position in its own stack frame,
+// there is nothing to undo and no history is pushed
+u_long64_t Perft::perft(const Position &position, int depth) {
+  if(depth == 0) {
+    return 1;
+  }
+  // the leaves don't have to be made, counting the moves of their parent is enough
+  if(depth == 1) {
+    return position.count_legal_moves();
+  }
+
+  u_long64_t nodes = 0;
+  MoveList moves;
+  position.generate_legal_moves(position.turn, moves);
+  Position child;
+  for(PackedMove move : moves) {
+    position.make_move(move, child);
+    nodes += perft(child, depth - 1);
+  }
+  return nodes;
+}
+
+u_long64_t Perft::perft(const Position &position, int depth, PerftTable &table) {
+  // subtrees of depth 1 are cheaper to count than to look up
+  if(depth < 2) {
+    return perft(position, depth);
+  }
+
+  u_long64_t nodes = 0;
+  if(table.probe(position.zobrist_key, depth, nodes)) {
+    return nodes;
+  }
+
+  MoveList moves;
+  position.generate_legal_moves(position.turn, moves);
+  Position child;
+  for(PackedMove move : moves) {
+    position.make_move(move, child);
+    nodes += perft(child, depth - 1, table);
+  }
+
+  table.store(position.zobrist_key, depth, nodes);
+  return nodes;
+}
+
+std::map<std::string, u_long64_t> Perft::divide(const Position &position, int depth, PerftTable *table) {
+  std::map<std::string, u_long64_t> result;
+  if(depth == 0) {
+    return result;
+  }
+
+  MoveList moves;
+  position.generate_legal_moves(position.turn, moves);
+  Position child;
+  for(PackedMove move : moves) {
+    position.make_move(move, child);
+    result[move.perft_str()] = table != nullptr ? perft(child, depth - 1, *table) : perft(child, depth - 1);
+  }
+  return result;
+}
+
+std::map<std::string, u_long64_t> Perft::parallel_divide(const Position &position, int depth, int threads,
+  int split_ply, PerftTable *table) {
+  std::map<std::string, u_long64_t> result;
+  if(depth == 0) {
+    return result;
+  }
+  // the root moves are always split, the tasks can't go deeper than the leaves
+  split_ply = std::max(1, std::min(split_ply, depth));
+
+  MoveList root_moves;
+  position.generate_legal_moves(position.turn, root_moves);
+
+  std::vector<PerftTask> tasks;
+  Position child;
+  for(int i = 0; i < root_moves.size(); i++) {
+    position.make_move(root_moves[i], child);
+    collect_tasks(child, split_ply - 1, i, tasks);
+  }
+
+  std::vector<std::atomic<u_long64_t>> counts(root_moves.size());
+  for(auto &count : counts) {
+    count.store(0);
+  }
+
+  ThreadPool pool(threads);
+  int remaining_depth = depth - split_ply;
+
+  // every task has its own copy of the position, so the workers share nothing but the table
+  for(const PerftTask &task : tasks) {
+    pool.submit([&, task](int) {
+      u_long64_t nodes = table != nullptr ? perft(task.position, remaining_depth, *table) : perft(task.position, remaining_depth);
+      counts[task.root_move].fetch_add(nodes, std::memory_order_relaxed);
+    });
+  }
+  pool.wait();
+
+  for(int i = 0; i < root_moves.size(); i++) {
+    result[root_moves[i].perft_str()] = counts[i].load();
+  }
+  return result;
+}
@@ -30,6 +30,11 @@ public:
         return piece & colourMask;
     }
 
+    // 0 for white, 1 for black, used to index per colour tables like GameState::colour_bitboards
+    static int colour_index(int piece) {
+        return (piece & colourMask) >> 4;
+    }
+
     static int piece_type(int piece) {
         return piece & typeMask;
     }
@@ -0,0 +1,793 @@
+#include "Position.h"
+#include "ChessConstants.h"
+#include "Attacks.h"
+#include <algorithm>
+#include <charconv>
+#include <cstring>
+
+// board is going from 0 in the top left corner where the black pieces are
+// to 63 in the bottom right corner where the white pieces are
+// 0  1  2  3  4  5  6  7
+// 8  9  10 11 12 13 14 15
+// 16 17 18 19 20 21 22 23
+// 24 25 26 27 28 29 30 31
+// 32 33 34 35 36 37 38 39
+// 40 41 42 43 44 45 46 47
+// 48 49 50 51 52 53 54 55
+// 56 57 58 59 60 61 62 63
+
+namespace {
+  // everything about the side to move that the generators used to branch on at runtime,
+  // known at compile time inside the functions templated on the colour Us
+  template<int Us>
+  struct Side {
+    static constexpr bool is_white = Us == Piece::White;
+    static constexpr int Them = is_white ? Piece::Black : Piece::White;
+    static constexpr int index = is_white ? 0 : 1;
+    static constexpr int them_index = 1 - index;
+    static constexpr int MOVE_DIR = is_white ? DIR_UP : DIR_DOWN;
+    // ranks, 1 to 8 as returned by get_rank
+    static constexpr int back_rank = is_white ? 1 : 8;
+    static constexpr int start_rank = is_white ? 2 : 7;
+    static constexpr int double_push_rank = is_white ? 4 : 5;
+    static constexpr int promotion_rank = is_white ? 7 : 2;
+    static constexpr int king_start = is_white ? 60 : 4;
+    static constexpr char king_side = is_white ? WHITE_KING_SIDE : BLACK_KING_SIDE;
+    static constexpr char queen_side = is_white ? WHITE_QUEEN_SIDE : BLACK_QUEEN_SIDE;
+  };
+}
+
+template<Attacks::SliderBackend B>
+constexpr Position::SliderFunctions Position::slider_functions_for() {
+  return SliderFunctions{
+    B,
+    {&Position::generate_legal_moves<Piece::White, B>, &Position::generate_legal_moves<Piece::Black, B>},
+    {&Position::count_legal_moves<Piece::White, B>, &Position::count_legal_moves<Piece::Black, B>},
+    {&Position::attacked_squares<Piece::White, B>, &Position::attacked_squares<Piece::Black, B>},
+    {&Position::pinned_pieces<Piece::White, B>, &Position::pinned_pieces<Piece::Black, B>},
+    &Position::attackers_to<B>
+  };
+}
+
+const Position::SliderFunctions Position::MAGIC_FUNCTIONS = slider_functions_for<Attacks::SliderBackend::Magic>();
+const Position::SliderFunctions Position::PEXT_FUNCTIONS = slider_functions_for<Attacks::SliderBackend::Pext>();
+
+// magics until the CPU is checked below, so positions used during static initialization work as well
+const Position::SliderFunctions *Position::slider_functions = &Position::MAGIC_FUNCTIONS;
+
+namespace {
+  // AMD before Zen 3 has BMI2 with a microcoded PEXT that is slower than magics
+  const bool pext_at_startup = Attacks::cpu_has_fast_pext() && Position::set_slider_backend(Attacks::SliderBackend::Pext);
+}
+
+Attacks::SliderBackend Position::get_slider_backend() {
+  return slider_functions->backend;
+}
+
+bool Position::set_slider_backend(Attacks::SliderBackend backend) {
+  if(backend == Attacks::SliderBackend::Pext && !Attacks::cpu_has_pext()) {
+    return false;
+  }
+  slider_functions = backend == Attacks::SliderBackend::Pext ? &PEXT_FUNCTIONS : &MAGIC_FUNCTIONS;
+  return true;
+}
+
+void Position::generate_legal_moves(char color, MoveList &legal_moves, GenType type) const {
+  (this->*slider_functions->generate_legal_moves[Piece::colour_index(color)])(legal_moves, type);
+}
+
+template<int Us, Attacks::SliderBackend B>
+void Position::generate_legal_moves(MoveList &legal_moves, GenType type) const {
+  // Instead of making every pseudolegal move and checking if the king is attacked afterwards,
+  // compute once which pieces give check and which of our pieces are pinned, then generate only legal moves:
+  // - in a double check only the king can move
+  // - in a single check other pieces can only capture the checker or block the check (check_mask)
+  // - a pinned piece can only move along the line between the king and the pinning piece
+  using S = Side<Us>;
+  int king_square = king_square_of<Us>();
+  u_long64_t checkers = attackers_to<B>(king_square, occupancy()) & colour_bitboards[S::them_index];
+  // squares the pieces other than pawns may move to for the requested type of moves
+  u_long64_t type_mask = type_targets<Us>(type);
+
+  if(checkers && type == GenType::All) {
+    generate_evasions<Us, B>(checkers, legal_moves);
+    return;
+  }
+
+  if(Bitboard::popcount(checkers) < 2) {
+    u_long64_t check_mask = ~0ULL;
+    if(checkers) {
+      int checker = Bitboard::lsb(checkers);
+      check_mask = Attacks::between(king_square, checker) | checkers;
+    }
+    u_long64_t pinned = pinned_pieces<Us, B>();
+
+    u_long64_t pieces = colour_bitboards[S::index] & ~piece_bitboards[Piece::King];
+    while(pieces) {
+      int i = Bitboard::pop_lsb(pieces);
+      u_long64_t allowed = check_mask;
+      if(Bitboard::is_set(pinned, i)) {
+        allowed &= Attacks::line(king_square, i);
+      }
+
+      int piece_type = Piece::piece_type(this->board[i]);
+      if(piece_type == Piece::Pawn) {
+        add_legal_pawn_moves<Us, B>(i, allowed, king_square, legal_moves, type);
+        continue;
+      }
+
+      u_long64_t targets = 0;
+      if(piece_type == Piece::Knight) {
+        targets = Attacks::knight_attacks(i);
+      } else {
+        if(Piece::is_rook_or_queen(this->board[i])) {
+          targets |= Attacks::rook_attacks<B>(i, occupancy());
+        }
+        if(Piece::is_bishop_or_queen(this->board[i])) {
+          targets |= Attacks::bishop_attacks<B>(i, occupancy());
+        }
+      }
+      add_moves(i, targets & type_mask & allowed, legal_moves);
+    }
+  }
+
+  // squares the opponent attacks, computed without our king on the board,
+  // so that the king can't step back along the line of a slider that is checking it
+  u_long64_t king_bb = Bitboard::square_bb(king_square);
+  u_long64_t attacked = attacked_squares<S::Them, B>(occupancy() ^ king_bb);
+  add_moves(king_square, Attacks::king_attacks(king_square) & type_mask & ~attacked, legal_moves);
+
+  // we cannot castle out of a check
+  if(checkers == 0 && (type == GenType::Quiet || type == GenType::All)) {
+    add_castling_moves<Us>(king_square, attacked, legal_moves);
+  }
+}
+
+template<int Us, Attacks::SliderBackend B>
+void Position::generate_evasions(u_long64_t checkers, MoveList &moves) const {
+  // Only three kinds of moves get out of a check: the king steps away, the checker is captured
+  // or a piece is put between the king and a sliding checker. Instead of generating every move of every piece
+  // and masking it with the check mask, the squares that resolve the check are the starting point
+  // and the pieces that can move there are found with attackers_to.
+  using S = Side<Us>;
+  int king_square = king_square_of<Us>();
+  u_long64_t own_pieces = colour_bitboards[S::index];
+  u_long64_t king_bb = Bitboard::square_bb(king_square);
+
+  u_long64_t attacked = attacked_squares<S::Them, B>(occupancy() ^ king_bb);
+  add_moves(king_square, Attacks::king_attacks(king_square) & ~own_pieces & ~attacked, moves);
+
+  // in a double check only the king can move
+  if(Bitboard::popcount(checkers) > 1) {
+    return;
+  }
+
+  // a pinned piece can never get out of a check, it would have to move off its pin line
+  u_long64_t defenders = own_pieces & ~king_bb & ~pinned_pieces<Us, B>();
+  u_long64_t own_pawns = piece_bitboards[Piece::Pawn] & defenders;
+  int checker = Bitboard::lsb(checkers);
+
+  // captures of the checker, attackers_to also finds pawns that can capture it
+  u_long64_t capturers = attackers_to<B>(checker, occupancy()) & defenders;
+  while(capturers) {
+    int start = Bitboard::pop_lsb(capturers);
+    if(Bitboard::is_set(own_pawns, start)) {
+      add_pawn_move(start, checker, moves, GenType::All);
+    } else {
+      add_moves(start, checkers, moves);
+    }
+  }
+
+  // a pawn that just made a double push and gives check can also be captured en passant
+  if(this->en_passant_target != NO_EN_PASSANT && checker == this->en_passant_target - S::MOVE_DIR) {
+    u_long64_t ep_capturers = Attacks::pawn_attacks(S::Them, this->en_passant_target) & own_pawns;
+    while(ep_capturers) {
+      int start = Bitboard::pop_lsb(ep_capturers);
+      if(is_en_passant_legal<Us, B>(start, king_square)) {
+        moves.push_back(PackedMove(start, this->en_passant_target, PackedMove::EN_PASSANT));
+      }
+    }
+  }
+
+  // blocks, only possible against a slider that is not next to the king
+  u_long64_t blocks = Attacks::between(king_square, checker);
+  while(blocks) {
+    int target = Bitboard::pop_lsb(blocks);
+    // pieces that attack an empty square can move there, except pawns which only capture diagonally
+    u_long64_t blockers = attackers_to<B>(target, occupancy()) & defenders & ~own_pawns;
+    while(blockers) {
+      int start = Bitboard::pop_lsb(blockers);
+      add_moves(start, Bitboard::square_bb(target), moves);
+    }
+
+    // pawn pushes, the double push only from the start rank over an empty square,
+    // no pawn can move to its own back rank
+    int target_rank = get_rank(target);
+    if(target_rank == S::back_rank) {
+      continue;
+    }
+    int single_push_start = target - S::MOVE_DIR;
+    if(Bitboard::is_set(own_pawns, single_push_start)) {
+      add_pawn_move(single_push_start, target, moves, GenType::All);
+    } else if(this->board[single_push_start] == 0) {
+      int double_push_start = target - 2 * S::MOVE_DIR;
+      if(target_rank == S::double_push_rank && Bitboard::is_set(own_pawns, double_push_start)) {
+        add_pawn_move(double_push_start, target, moves, GenType::All);
+      }
+    }
+  }
+}
+
+template<int Us>
+u_long64_t Position::type_targets(GenType type) const {
+  switch(type) {
+    case GenType::Tactical:
+    case GenType::Captures:
+      return colour_bitboards[Side<Us>::them_index];
+    case GenType::Quiet:
+      return ~occupancy();
+    default:
+      return ~colour_bitboards[Side<Us>::index];
+  }
+}
+
+int Position::count_legal_moves() const {
+  return (this->*slider_functions->count_legal_moves[Piece::colour_index(this->turn)])();
+}
+
+template<int Us, Attacks::SliderBackend B>
+int Position::count_legal_moves() const {
+  // the same steps as generate_legal_moves, but every piece adds the popcount of its targets
+  // instead of pushing a Move per target
+  using S = Side<Us>;
+  int king_square = king_square_of<Us>();
+  u_long64_t own_pieces = colour_bitboards[S::index];
+  u_long64_t checkers = attackers_to<B>(king_square, occupancy()) & colour_bitboards[S::them_index];
+  int count = 0;
+
+  if(Bitboard::popcount(checkers) < 2) {
+    u_long64_t check_mask = ~0ULL;
+    if(checkers) {
+      check_mask = Attacks::between(king_square, Bitboard::lsb(checkers)) | checkers;
+    }
+    u_long64_t pinned = pinned_pieces<Us, B>();
+
+    u_long64_t pieces = own_pieces & ~piece_bitboards[Piece::King];
+    while(pieces) {
+      int i = Bitboard::pop_lsb(pieces);
+      u_long64_t allowed = check_mask;
+      if(Bitboard::is_set(pinned, i)) {
+        allowed &= Attacks::line(king_square, i);
+      }
+
+      int piece_type = Piece::piece_type(this->board[i]);
+      if(piece_type == Piece::Pawn) {
+        // pawns on the promotion rank promote, every target counts as four moves
+        int targets = Bitboard::popcount(legal_pawn_targets<Us>(i, allowed));
+        count += get_rank(i) == S::promotion_rank ? targets * 4 : targets;
+        count += is_en_passant_legal<Us, B>(i, king_square);
+        continue;
+      }
+
+      u_long64_t targets = 0;
+      if(piece_type == Piece::Knight) {
+        targets = Attacks::knight_attacks(i);
+      } else {
+        if(Piece::is_rook_or_queen(this->board[i])) {
+          targets |= Attacks::rook_attacks<B>(i, occupancy());
+        }
+        if(Piece::is_bishop_or_queen(this->board[i])) {
+          targets |= Attacks::bishop_attacks<B>(i, occupancy());
+        }
+      }
+      count += Bitboard::popcount(targets & ~own_pieces & allowed);
+    }
+  }
+
+  u_long64_t king_bb = Bitboard::square_bb(king_square);
+  u_long64_t attacked = attacked_squares<S::Them, B>(occupancy() ^ king_bb);
+  count += Bitboard::popcount(Attacks::king_attacks(king_square) & ~own_pieces & ~attacked);
+  if(checkers == 0) {
+    count += Bitboard::popcount(castling_targets<Us>(king_square, attacked));
+  }
+  return count;
+}
+
+void Position::generate_captures(MoveList &moves) const {
+  generate_legal_moves(this->turn, moves, GenType::Captures);
+}
+
+template<int Us>
+void Position::add_castling_moves(int king_square, u_long64_t attacked, MoveList &moves) const {
+  u_long64_t targets = castling_targets<Us>(king_square, attacked);
+  while(targets) {
+    int target = Bitboard::pop_lsb(targets);
+    moves.push_back(PackedMove(king_square, target, target > king_square ? PackedMove::CASTLE_KINGSIDE : PackedMove::CASTLE_QUEENSIDE));
+  }
+}
+
+template<int Us>
+u_long64_t Position::castling_targets(int king_square, u_long64_t attacked) const {
+  using S = Side<Us>;
+  const char *kingside_squares = S::is_white ? WHITE_KINGSIDE_SQUARES : BLACK_KINGSIDE_SQUARES;
+  const char *queenside_squares = S::is_white ? WHITE_QUEENSIDE_SQUARES : BLACK_QUEENSIDE_SQUARES;
+  u_long64_t targets = 0;
+  if(king_square != S::king_start) {
+    return targets;
+  }
+  // the squares the king passes and lands on must be empty and not attacked,
+  // on the queenside the square next to the rook only has to be empty
+  if((castling_rights & S::king_side) == S::king_side
+    && board[S::king_start + 1] == 0 && board[S::king_start + 2] == 0
+    && !Bitboard::is_set(attacked, kingside_squares[0]) && !Bitboard::is_set(attacked, kingside_squares[1])) {
+    targets |= Bitboard::square_bb(king_square + 2);
+  }
+  if((castling_rights & S::queen_side) == S::queen_side
+    && board[S::king_start - 1] == 0 && board[S::king_start - 2] == 0 && board[S::king_start - 3] == 0
+    && !Bitboard::is_set(attacked, queenside_squares[0]) && !Bitboard::is_set(attacked, queenside_squares[1])) {
+    targets |= Bitboard::square_bb(king_square - 2);
+  }
+  return targets;
+}
+
+u_long64_t Position::attacked_squares(char color, u_long64_t occupancy) const {
+  return (this->*slider_functions->attacked_squares[Piece::colour_index(color)])(occupancy);
+}
+
+template<int Us, Attacks::SliderBackend B>
+u_long64_t Position::attacked_squares(u_long64_t occupancy) const {
+  using S = Side<Us>;
+  u_long64_t attacked = Attacks::all_pawn_attacks(Us, piece_bitboards[Piece::Pawn] & colour_bitboards[S::index]);
+
+  u_long64_t knights = piece_bitboards[Piece::Knight] & colour_bitboards[S::index];
+  while(knights) {
+    attacked |= Attacks::knight_attacks(Bitboard::pop_lsb(knights));
+  }
+
+  u_long64_t straight_sliders = (piece_bitboards[Piece::Rook] | piece_bitboards[Piece::Queen]) & colour_bitboards[S::index];
+  while(straight_sliders) {
+    attacked |= Attacks::rook_attacks<B>(Bitboard::pop_lsb(straight_sliders), occupancy);
+  }
+
+  u_long64_t diagonal_sliders = (piece_bitboards[Piece::Bishop] | piece_bitboards[Piece::Queen]) & colour_bitboards[S::index];
+  while(diagonal_sliders) {
+    attacked |= Attacks::bishop_attacks<B>(Bitboard::pop_lsb(diagonal_sliders), occupancy);
+  }
+
+  attacked |= Attacks::king_attacks(king_square_of<Us>());
+
+  return attacked;
+}
+
+void Position::add_moves(int start, u_long64_t targets, MoveList &moves) const {
+  while(targets) {
+    int target = Bitboard::pop_lsb(targets);
+    moves.push_back(PackedMove(start, target, this->board[target] == 0 ? PackedMove::NORMAL : PackedMove::CAPTURE));
+  }
+}
+
+template<int Us, Attacks::SliderBackend B>
+void Position::add_legal_pawn_moves(int i, u_long64_t allowed, int king_square, MoveList &moves, GenType type) const {
+  u_long64_t targets = legal_pawn_targets<Us>(i, allowed);
+  // every promotion is a tactical move, also the ones that don't capture
+  if(get_rank(i) == Side<Us>::promotion_rank) {
+    targets = type == GenType::Quiet ? 0 : targets;
+  } else {
+    targets &= type_targets<Us>(type);
+  }
+  while(targets) {
+    add_pawn_move(i, Bitboard::pop_lsb(targets), moves, type);
+  }
+
+  if(type != GenType::Quiet && is_en_passant_legal<Us, B>(i, king_square)) {
+    moves.push_back(PackedMove(i, this->en_passant_target, PackedMove::EN_PASSANT));
+  }
+}
+
+void Position::add_pawn_move(int start, int target, MoveList &moves, GenType type) const {
+  int capture = this->board[target] == 0 ? 0 : PackedMove::CAPTURE;
+  // pawns promote on the first and the last row of the board
+  if(target < 8 || target >= 56) {
+    if(type != GenType::Captures) {
+      moves.push_back(PackedMove(start, target, PackedMove::PROMOTION_BISHOP | capture));
+      moves.push_back(PackedMove(start, target, PackedMove::PROMOTION_KNIGHT | capture));
+      moves.push_back(PackedMove(start, target, PackedMove::PROMOTION_ROOK | capture));
+    }
+    moves.push_back(PackedMove(start, target, PackedMove::PROMOTION_QUEEN | capture));
+  } else if(target - start == 2 * DIR_UP || target - start == 2 * DIR_DOWN) {
+    moves.push_back(PackedMove(start, target, PackedMove::DOUBLE_PUSH));
+  } else {
+    moves.push_back(PackedMove(start, target, capture == 0 ? PackedMove::NORMAL : PackedMove::CAPTURE));
+  }
+}
+
+template<int Us>
+u_long64_t Position::legal_pawn_targets(int i, u_long64_t allowed) const {
+  using S = Side<Us>;
+  u_long64_t targets = 0;
+  // pushes, the pawn never walks off the board because it promotes on the last rank
+  if(this->board[i + S::MOVE_DIR] == 0) {
+    targets |= Bitboard::square_bb(i + S::MOVE_DIR);
+    if(get_rank(i) == S::start_rank && this->board[i + S::MOVE_DIR * 2] == 0) {
+      targets |= Bitboard::square_bb(i + S::MOVE_DIR * 2);
+    }
+  }
+  targets |= Attacks::pawn_attacks(Us, i) & colour_bitboards[S::them_index];
+  return targets & allowed;
+}
+
+template<int Us, Attacks::SliderBackend B>
+bool Position::is_en_passant_legal(int i, int king_square) const {
+  // En passant is the one move the masks can't handle, it removes two pawns from the same rank at once
+  // and can uncover an attack on the king, so check the position after the capture directly
+  using S = Side<Us>;
+  if(this->en_passant_target == NO_EN_PASSANT || !Bitboard::is_set(Attacks::pawn_attacks(Us, i), this->en_passant_target)) {
+    return false;
+  }
+
+  int captured_square = this->en_passant_target - S::MOVE_DIR;
+  u_long64_t captured = Bitboard::square_bb(captured_square);
+  u_long64_t occupancy_after = (occupancy() ^ Bitboard::square_bb(i) ^ captured) | Bitboard::square_bb(this->en_passant_target);
+  u_long64_t attackers = attackers_to<B>(king_square, occupancy_after) & colour_bitboards[S::them_index] & ~captured;
+  return attackers == 0;
+}
+
+u_long64_t Position::attackers_to(int square, u_long64_t occupancy) const {
+  return (this->*slider_functions->attackers_to)(square, occupancy);
+}
+
+template<Attacks::SliderBackend B>
+u_long64_t Position::attackers_to(int square, u_long64_t occupancy) const {
+  // a piece on the square attacks the same squares it is attacked from,
+  // only pawns are the other way around so the colours are swapped
+  return (Attacks::pawn_attacks(Piece::White, square) & pieces(Piece::Pawn, Piece::Black))
+    | (Attacks::pawn_attacks(Piece::Black, square) & pieces(Piece::Pawn, Piece::White))
+    | (Attacks::knight_attacks(square) & piece_bitboards[Piece::Knight])
+    | (Attacks::king_attacks(square) & piece_bitboards[Piece::King])
+    | (Attacks::rook_attacks<B>(square, occupancy) & (piece_bitboards[Piece::Rook] | piece_bitboards[Piece::Queen]))
+    | (Attacks::bishop_attacks<B>(square, occupancy) & (piece_bitboards[Piece::Bishop] | piece_bitboards[Piece::Queen]));
+}
+
+u_long64_t Position::pinned_pieces(char color) const {
+  return (this->*slider_functions->pinned_pieces[Piece::colour_index(color)])();
+}
+
+template<int Us, Attacks::SliderBackend B>
+u_long64_t Position::pinned_pieces() const {
+  using S = Side<Us>;
+  int king_square = king_square_of<Us>();
+  u_long64_t opponent_pieces = colour_bitboards[S::them_index];
+
+  // opponent sliders that would attack the king if our pieces were not on the board
+  u_long64_t snipers = (Attacks::rook_attacks<B>(king_square, opponent_pieces)
+      & (piece_bitboards[Piece::Rook] | piece_bitboards[Piece::Queen]) & opponent_pieces)
+    | (Attacks::bishop_attacks<B>(king_square, opponent_pieces)
+      & (piece_bitboards[Piece::Bishop] | piece_bitboards[Piece::Queen]) & opponent_pieces);
+
+  u_long64_t pinned = 0;
+  while(snipers) {
+    int sniper = Bitboard::pop_lsb(snipers);
+    u_long64_t blockers = Attacks::between(king_square, sniper) & occupancy();
+    // a piece is pinned when it is the only one standing between the king and the slider
+    if(Bitboard::popcount(blockers) == 1 && (blockers & colour_bitboards[S::index])) {
+      pinned |= blockers;
+    }
+  }
+  return pinned;
+}
+
+void Position::apply_move(PackedMove move) {
+  if(this->turn == Piece::White) {
+    apply_move<Piece::White>(move);
+  } else {
+    apply_move<Piece::Black>(move);
+  }
+}
+
+template<int Us>
+void Position::apply_move(PackedMove move) {
+  using S = Side<Us>;
+  // the rook squares of a castle
+  constexpr int kingside_rook = S::is_white ? 63 : 7;
+  constexpr int queenside_rook = S::is_white ? 56 : 0;
+
+  // the zobrist key is updated by xoring out everything that changes and xoring in the new values
+  // castling rights and en passant are xored out here and back in once they are updated
+  u_long64_t key = this->zobrist_key ^ Zobrist::castling(this->castling_rights);
+  if(this->en_passant_target != NO_EN_PASSANT) {
+    key ^= Zobrist::en_passant(this->en_passant_target);
+  }
+
+  // the moving piece is read from the board, the packed move does not store it
+  int start = move.start();
+  int end = move.end();
+  int piece_type = Piece::piece_type(this->board[start]);
+
+  // update the board
+  if(this->board[end] != 0) {
+    key ^= Zobrist::piece(this->board[end], end);
+    remove_piece(end);
+  }
+  key ^= Zobrist::piece(this->board[start], start);
+  move_piece(start, end);
+
+  // if it's a promotion, change the piece type
+  if(move.is_promotion()) {
+    remove_piece(end);
+    put_piece(end, move.promotion_piece() | Us);
+  }
+  key ^= Zobrist::piece(this->board[end], end);
+
+  // if it's a double push, set the en passant target
+  if(move.is_double_push()) {
+    this->en_passant_target = end - S::MOVE_DIR;
+  } else {
+    this->en_passant_target = NO_EN_PASSANT;
+  }
+
+  // if it's a castle, move the rook
+  if(move.is_castle()) {
+    if(move.is_castle_kingside()) {
+      move_piece(kingside_rook, kingside_rook - 2);
+      key ^= Zobrist::piece(Us | Piece::Rook, kingside_rook) ^ Zobrist::piece(Us | Piece::Rook, kingside_rook - 2);
+    } else {
+      move_piece(queenside_rook, queenside_rook + 3);
+      key ^= Zobrist::piece(Us | Piece::Rook, queenside_rook) ^ Zobrist::piece(Us | Piece::Rook, queenside_rook + 3);
+    }
+  }
+
+  // if its an en passant capture, remove the captured pawn
+  if(move.is_en_passant()) {
+    key ^= Zobrist::piece(this->board[end - S::MOVE_DIR], end - S::MOVE_DIR);
+    remove_piece(end - S::MOVE_DIR);
+  }
+
+  // update castling rights and king square
+  if(piece_type == Piece::King) {
+    this->castling_rights &= ~(S::king_side | S::queen_side);
+    if(S::is_white) {
+      this->white_king_square = end;
+    } else {
+      this->black_king_square = end;
+    }
+  }
+
+  // subtract castle rights if the rook is captured or moved
+  if(end == 63 || start == 63) {
+    this->castling_rights &= ~WHITE_KING_SIDE;
+  }
+  if(end == 56 || start == 56) {
+    this->castling_rights &= ~WHITE_QUEEN_SIDE;
+  }
+  if(end == 7 || start == 7) {
+    this->castling_rights &= ~BLACK_KING_SIDE;
+  }
+  if(end == 0 || start == 0) {
+    this->castling_rights &= ~BLACK_QUEEN_SIDE;
+  }
+
+  // update halfmove clock, reset by captures and pawn moves
+  if(move.is_capture() || move.is_en_passant() || piece_type == Piece::Pawn) {
+    this->halfmove_clock = 0;
+  } else {
+    this->halfmove_clock++;
+  }
+
+  // update fullmove counter
+  if(!S::is_white) {
+    this->fullmove_counter++;
+  }
+
+  // update turn
+  this->turn = S::Them;
+
+  key ^= Zobrist::castling(this->castling_rights) ^ Zobrist::keys.black_to_move;
+  if(this->en_passant_target != NO_EN_PASSANT) {
+    key ^= Zobrist::en_passant(this->en_passant_target);
+  }
+  this->zobrist_key = key;
+}
+
+void Position::make_move(PackedMove move, Position &child) const {
+  child = *this;
+  child.apply_move(move);
+}
+
+bool Position::is_square_attacked(int square, char color) const {
+  int opponent_col = color == Piece::White ? Piece::Black : Piece::White;
+  return (attackers_to(square, occupancy()) & colour_bitboards[Piece::colour_index(opponent_col)]) != 0;
+};
+
+void Position::put_piece(int square, int piece) {
+  u_long64_t bb = Bitboard::square_bb(square);
+  this->board[square] = piece;
+  this->piece_bitboards[Piece::piece_type(piece)] |= bb;
+  this->colour_bitboards[Piece::colour_index(piece)] |= bb;
+}
+
+void Position::remove_piece(int square) {
+  u_long64_t bb = Bitboard::square_bb(square);
+  int piece = this->board[square];
+  this->board[square] = 0;
+  this->piece_bitboards[Piece::piece_type(piece)] &= ~bb;
+  this->colour_bitboards[Piece::colour_index(piece)] &= ~bb;
+}
+
+void Position::move_piece(int start, int end) {
+  // a single xor flips both the start and the end bit
+  u_long64_t bb = Bitboard::square_bb(start) | Bitboard::square_bb(end);
+  int piece = this->board[start];
+  this->board[end] = piece;
+  this->board[start] = 0;
+  this->piece_bitboards[Piece::piece_type(piece)] ^= bb;
+  this->colour_bitboards[Piece::colour_index(piece)] ^= bb;
+}
+
+void Position::clear_board() {
+  this->board.fill(0);
+  this->piece_bitboards.fill(0);
+  this->colour_bitboards.fill(0);
+}
+
+u_long64_t Position::compute_zobrist_key() const {
+  u_long64_t key = 0;
+  for(int i = 0; i < 64; i++) {
+    if(this->board[i] != 0) {
+      key ^= Zobrist::piece(this->board[i], i);
+    }
+  }
+  if(this->turn == Piece::Black) {
+    key ^= Zobrist::keys.black_to_move;
+  }
+  key ^= Zobrist::castling(this->castling_rights);
+  if(this->en_passant_target != NO_EN_PASSANT) {
+    key ^= Zobrist::en_passant(this->en_passant_target);
+  }
+  return key;
+}
+
+namespace {
+  // FEN letter of every piece, indexed by type | colour
+  constexpr char PIECE_LETTERS[24] = {
+    0, 0, 0, 0, 0, 0, 0, 0,
+    0, 'K', 'P', 'N', 0, 'B', 'R', 'Q',
+    0, 'k', 'p', 'n', 0, 'b', 'r', 'q'
+  };
+
+  // the board, side to move, castling rights and en passant fields shared by FEN and EPD,
+  // out needs room for MAX_FEN_LENGTH characters, returns the end of what was written
+  char *write_position_fields(const Position &position, char *out) {
+    for(int rank = 0; rank < 8; rank++) {
+      int empty = 0;
+      for(int square = rank * 8; square < rank * 8 + 8; square++) {
+        int piece = position.board[square];
+        if(piece == Piece::NonePiece) {
+          empty++;
+          continue;
+        }
+        if(empty > 0) {
+          *out++ = (char)('0' + empty);
+          empty = 0;
+        }
+        *out++ = PIECE_LETTERS[piece];
+      }
+      if(empty > 0) {
+        *out++ = (char)('0' + empty);
+      }
+      if(rank < 7) {
+        *out++ = '/';
+      }
+    }
+
+    *out++ = ' ';
+    *out++ = position.turn == Piece::White ? 'w' : 'b';
+
+    *out++ = ' ';
+    if(position.castling_rights == 0) {
+      *out++ = '-';
+    } else {
+      if(position.castling_rights & WHITE_KING_SIDE) {
+        *out++ = 'K';
+      }
+      if(position.castling_rights & WHITE_QUEEN_SIDE) {
+        *out++ = 'Q';
+      }
+      if(position.castling_rights & BLACK_KING_SIDE) {
+        *out++ = 'k';
+      }
+      if(position.castling_rights & BLACK_QUEEN_SIDE) {
+        *out++ = 'q';
+      }
+    }
+
+    *out++ = ' ';
+    if(position.en_passant_target == -1) {
+      *out++ = '-';
+    } else {
+      *out++ = (char)('a' + position.en_passant_target % 8);
+      *out++ = (char)('8' - position.en_passant_target / 8);
+    }
+    return out;
+  }
+
+  // copy the length characters of text and a terminating null into buffer if they fit
+  size_t copy_to_buffer(const char *text, size_t length, char *buffer, size_t size) {
+    if(length + 1 > size) {
+      return 0;
+    }
+    std::memcpy(buffer, text, length);
+    buffer[length] = '\0';
+    return length;
+  }
+}
+
+size_t Position::to_fen(char *buffer, size_t size) const noexcept {
+  // written to the stack first, so a too small buffer is never partly written
+  char fen[MAX_FEN_LENGTH + 1];
+  char *end = fen + MAX_FEN_LENGTH;
+  char *out = write_position_fields(*this, fen);
+  *out++ = ' ';
+  out = std::to_chars(out, end, halfmove_clock).ptr;
+  *out++ = ' ';
+  out = std::to_chars(out, end, fullmove_counter).ptr;
+  return copy_to_buffer(fen, out - fen, buffer, size);
+}
+
+size_t Position::to_epd(char *buffer, size_t size, std::string_view operations) const noexcept {
+  char fields[MAX_FEN_LENGTH + 1];
+  size_t length = write_position_fields(*this, fields) - fields;
+  if(operations.empty()) {
+    return copy_to_buffer(fields, length, buffer, size);
+  }
+
+  size_t total = length + 1 + operations.size();
+  if(total + 1 > size) {
+    return 0;
+  }
+  std::memcpy(buffer, fields, length);
+  buffer[length] = ' ';
+  std::memcpy(buffer + length + 1, operations.data(), operations.size());
+  buffer[total] = '\0';
+  return total;
+}
+
+bool Position::is_possible_material(const std::array<int, 64> &board) {
+  // pieces of every type (indexed by Piece::piece_type) for both colours
+  int counts[2][8] = {};
+  for(int i = 0; i < 64; i++) {
+    if(board[i] != Piece::NonePiece) {
+      counts[Piece::colour_index(board[i])][Piece::piece_type(board[i])]++;
+    }
+  }
+
+  for(const int *count : counts) {
+    int pawns = count[Piece::Pawn];
+    int promoted = std::max(0, count[Piece::Queen] - 1) + std::max(0, count[Piece::Rook] - 2)
+      + std::max(0, count[Piece::Bishop] - 2) + std::max(0, count[Piece::Knight] - 2);
+    int pieces = pawns + count[Piece::Knight] + count[Piece::Bishop] + count[Piece::Rook] + count[Piece::Queen] + count[Piece::King];
+    if(pawns > 8 || pieces > 16 || promoted > 8 - pawns) {
+      return false;
+    }
+  }
+  return true;
+}
+
+void Position::init_bitboards() {
+  this->piece_bitboards.fill(0);
+  this->colour_bitboards.fill(0);
+  for(int i = 0; i < 64; i++) {
+    if(this->board[i] != 0) {
+      this->piece_bitboards[Piece::piece_type(this->board[i])] |= Bitboard::square_bb(i);
+      this->colour_bitboards[Piece::colour_index(this->board[i])] |= Bitboard::square_bb(i);
+    }
+  }
+}
+
+int Position::get_rank(int square) const { return 8 - (square / 8); }
+int Position::get_file(int square) const {return (square % 8) + 1;}
+
+// squares that cannot be attacked in order to castle on a given side
+const char Position::WHITE_KINGSIDE_SQUARES[2] = {61, 62};
+const char Position::WHITE_QUEENSIDE_SQUARES[2] = {59, 58};
+const char Position::BLACK_KINGSIDE_SQUARES[2] = {5, 6};
+const char Position::BLACK_QUEENSIDE_SQUARES[2] = {3, 2};
@@ -0,0 +1,22 @@
+#include "StagedMoveGenerator.h"
+
+StagedMoveGenerator::StagedMoveGenerator(const Position &position)
+  : position(position), current_stage(Stage::Tactical), index(0) {
+  position.generate_legal_moves(position.turn, moves, GenType::Tactical);
+}
+
+bool StagedMoveGenerator::next(PackedMove &move) {
+  // the loop moves on to the next stage when the current one is used up, a stage can be empty
+  while(index == moves.size()) {
+    if(current_stage != Stage::Tactical) {
+      current_stage = Stage::Done;
+      return false;
+    }
+    current_stage = Stage::Quiet;
+    moves.clear();
+    index = 0;
+    position.generate_legal_moves(position.turn, moves, GenType::Quiet);
+  }
+  move = moves[index++];
+  return true;
+}
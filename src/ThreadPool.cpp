@@ -0,0 +1,98 @@
+#include "ThreadPool.h"
+
+ThreadPool::ThreadPool(int threads) {
+  if(threads < 1) {
+    threads = 1;
+  }
+  for(int i = 0; i < threads; i++) {
+    queues.push_back(std::make_unique<WorkerQueue>());
+  }
+  for(int i = 0; i < threads; i++) {
+    workers.emplace_back(&ThreadPool::worker_loop, this, i);
+  }
+}
+
+ThreadPool::~ThreadPool() {
+  {
+    std::lock_guard<std::mutex> lock(state_mutex);
+    stopping = true;
+  }
+  work_available.notify_all();
+  for(auto &worker : workers) {
+    worker.join();
+  }
+}
+
+void ThreadPool::submit(std::function<void(int)> task) {
+  pending++;
+  WorkerQueue &queue = *queues[next_queue++ % queues.size()];
+  {
+    std::lock_guard<std::mutex> lock(queue.mutex);
+    queue.tasks.push_back(std::move(task));
+    queue.size++;
+  }
+
+  {
+    // counted only once the task is in a queue, so queued never exceeds the tasks in the queues,
+    // under state_mutex so a worker can not miss the wake up between its check and going to sleep
+    std::lock_guard<std::mutex> lock(state_mutex);
+    queued++;
+  }
+  work_available.notify_one();
+}
+
+void ThreadPool::wait() {
+  std::unique_lock<std::mutex> lock(state_mutex);
+  all_done.wait(lock, [this] { return pending == 0; });
+}
+
+bool ThreadPool::pop_task(int worker, std::function<void(int)> &task) {
+  for(int i = 0; i < (int)queues.size(); i++) {
+    WorkerQueue &queue = *queues[(worker + i) % queues.size()];
+    // empty queues are skipped without taking their lock
+    if(queue.size == 0) {
+      continue;
+    }
+    std::lock_guard<std::mutex> lock(queue.mutex);
+    if(queue.tasks.empty()) {
+      continue;
+    }
+    // the own queue is used from the back, the others are stolen from at the front
+    if(i == 0) {
+      task = std::move(queue.tasks.back());
+      queue.tasks.pop_back();
+    } else {
+      task = std::move(queue.tasks.front());
+      queue.tasks.pop_front();
+    }
+    // queued first, a worker that sees the queue empty then also sees the lower count and sleeps
+    queued--;
+    queue.size--;
+    return true;
+  }
+  return false;
+}
+
+void ThreadPool::worker_loop(int worker) {
+  while(true) {
+    std::function<void(int)> task;
+    if(!pop_task(worker, task)) {
+      std::unique_lock<std::mutex> lock(state_mutex);
+      // queued only goes down when a task is popped, so once every task is taken the worker sleeps
+      // instead of scanning the queues again
+      work_available.wait(lock, [this] { return queued > 0 || stopping; });
+      if(queued <= 0 && stopping) {
+        return;
+      }
+      continue;
+    }
+
+    task(worker);
+
+    if(--pending == 0) {
+      // the lock orders the notification after a waiter that saw pending > 0 went to sleep
+      std::lock_guard<std::mutex> lock(state_mutex);
+      all_done.notify_all();
+    }
+  }
+}
@@ -0,0 +1,52 @@
+#include "../include/GameState.h"
+#include "../include/ChessConstants.h"
+#include "../include/BatchAnalysis.h"
+#include "gtest/gtest.h"
+#include <sstream>
+
+TEST(BatchAnalysisTest, ResultsInInputOrder) {
+    std::string input =
+        STARTING_FEN "\n"
+        "r3k2r/p1ppqpb1/bn2pnp1/3PN3/1p2P3/2N2Q1p/PPPBBPPP/R3K2R w KQkq -\n"
+        "\n"
+        "not a position\n"
+        // 279 pseudo-legal moves, more than a MoveList holds, is rejected instead of analysed
+        "kQQQQQQQ/Q6Q/Q1Q4Q/Q6Q/Q6Q/Q6Q/Q6Q/BQQQQQQK w - - 0 1\n"
+        "8/2p5/3p4/KP5r/1R3p1k/8/4P1P1/8 w - - 0 1\r\n";
+
+    BatchAnalysis::Options options;
+    std::ostringstream out;
+    ASSERT_EQ(BatchAnalysis::run(input, out, options), 5);
+    std::string expected = "20\n48\nerror: Invalid FEN string, expected at least 4 space separated tokens\n"
+                           "error: Invalid board, more pawns or promoted pieces than a game can have\n14\n";
+    ASSERT_EQ(out.str(), expected);
+
+    // small chunks on many threads give the same output
+    std::string many;
+    std::string many_expected;
+    for (int i = 0; i < 200; i++) {
+        many += input;
+        many_expected += expected;
+    }
+    options.threads = 4;
+    options.chunk_bytes = 100;
+    std::ostringstream parallel_out;
+    ASSERT_EQ(BatchAnalysis::run(many, parallel_out, options), 1000);
+    ASSERT_EQ(parallel_out.str(), many_expected);
+
+    options.mode = BatchAnalysis::Mode::Moves;
+    std::ostringstream moves_out;
+    BatchAnalysis::run("4k3/8/8/8/8/8/8/4K2R w K - 0 1\n", moves_out, options);
+    std::istringstream moves(moves_out.str());
+    std::string move;
+    std::vector<std::string> move_list;
+    while (moves >> move) {
+        move_list.push_back(move);
+    }
+    ASSERT_EQ(move_list.size(), 15);
+    ASSERT_NE(std::find(move_list.begin(), move_list.end(), "e1g1"), move_list.end());
+
+    std::ostringstream queens_out;
+    BatchAnalysis::run("kQQQQQQQ/Q6Q/Q1Q4Q/Q6Q/Q6Q/Q6Q/Q6Q/BQQQQQQK w - - 0 1\n", queens_out, options);
+    ASSERT_EQ(queens_out.str(), "error: Invalid board, more pawns or promoted pieces than a game can have\n");
+}
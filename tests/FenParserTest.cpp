@@ -0,0 +1,118 @@
+#include "../include/GameState.h"
+#include "../include/ChessConstants.h"
+#include "../include/FenParser.h"
+#include "gtest/gtest.h"
+#include <cstring>
+
+// parsing in place into a used game gives the same position as parsing into a new one
+TEST(FenParserTest, ParseInPlaceMatchesParseFen) {
+    std::string kiwipete = "r3k2r/p1ppqpb1/bn2pnp1/3PN3/1p2P3/2N2Q1p/PPPBBPPP/R3K2R w KQkq - 0 1";
+    GameState game = FenParser::parse_fen(STARTING_FEN);
+    game.make_move_unchecked(game.get_legal_move_list()[0]);
+
+    ASSERT_TRUE(FenParser::parse_fen(std::string_view(kiwipete), game) == FenError::None);
+    GameState expected = FenParser::parse_fen(kiwipete);
+    ASSERT_EQ(game.board, expected.board);
+    ASSERT_EQ(game.zobrist_key, expected.zobrist_key);
+    ASSERT_EQ(game.get_legal_move_list().size(), 48);
+
+    // EPD, the operations are ignored and the clocks start at 0 and 1
+    ASSERT_TRUE(FenParser::parse_fen(std::string_view("4k3/8/8/8/8/8/4P3/4K3 b - - bm Kd7; id \"test\";"), game) == FenError::None);
+    ASSERT_TRUE(game.turn == Piece::Black);
+    ASSERT_EQ(game.halfmove_clock, 0);
+    ASSERT_EQ(game.fullmove_counter, 1);
+    ASSERT_EQ(game.count_legal_moves(), 5);
+
+}
+
+// malformed input gives an error code and leaves the game as it was
+TEST(FenParserTest, InvalidFenReturnsError) {
+    std::vector<std::pair<std::string, FenError>> invalid = {
+        {"", FenError::MissingFields},
+        {"rnbqkbnr/pppppppp w", FenError::MissingFields},
+        {"rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNX w KQkq - 0 1", FenError::UnknownPiece},
+        {"rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP w KQkq - 0 1", FenError::BoardSize},
+        {"rnbqkbnr/pppppppp/54/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - 0 1", FenError::BoardSize},
+        {"rnbqkbnrr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - 0 1", FenError::BoardSize},
+        {"rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR/8 w KQkq - 0 1", FenError::BoardSize},
+        {"8/8/8/8/8/8/8/8 w - - 0 1", FenError::KingCount},
+        {"k7/8/8/8/8/8/8/KK6 w - - 0 1", FenError::KingCount},
+        {"k6P/8/8/8/8/8/8/K7 w - - 0 1", FenError::PawnOnBackRank},
+        // 279 legal moves, more than a MoveList holds
+        {"kQQQQQQQ/Q6Q/Q1Q4Q/Q6Q/Q6Q/Q6Q/Q6Q/BQQQQQQK w - - 0 1", FenError::Material},
+        {"k7/PPPPPPPP/P7/8/8/8/8/K7 w - - 0 1", FenError::Material},
+        {"k7/8/8/8/8/8/PPPPPPPP/QQKBBNNR w - - 0 1", FenError::Material},
+        {"4k3/8/8/8/8/8/4R3/4K3 w - - 0 1", FenError::OpponentInCheck},
+        {"rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR x KQkq - 0 1", FenError::SideToMove},
+        {"rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkx - 0 1", FenError::CastlingRights},
+        {"rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBN1 w KQkq - 0 1", FenError::CastlingRights},
+        {"rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq e3 0 1", FenError::EnPassantSquare},
+        {"rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq z9 0 1", FenError::EnPassantSquare},
+        {"rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - 0", FenError::Clocks},
+        {"rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - 0 x", FenError::Clocks},
+        {"rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - 99999999999 1", FenError::Clocks},
+    };
+
+    GameState game;
+    for (auto &entry : invalid) {
+        ASSERT_TRUE(FenParser::parse_fen(std::string_view(entry.first), game) == entry.second) << entry.first;
+        ASSERT_EQ(game.zobrist_key, GameState().zobrist_key);
+    }
+
+    ASSERT_THROW(FenParser::parse_fen(std::string("8/8/8/8/8/8/8/8 w - - 0 1")), std::invalid_argument);
+    // set_position checks the material itself, boards that do not come from the parser can not overflow a MoveList
+    std::array<int, 64> queens;
+    ASSERT_TRUE(FenParser::parse_board("kQQQQQQQ/Q6Q/Q1Q4Q/Q6Q/Q6Q/Q6Q/Q6Q/BQQQQQQK", queens) == FenError::None);
+    ASSERT_FALSE(game.set_position(queens, Piece::White, 0, -1, 0, 1));
+    ASSERT_EQ(game.zobrist_key, GameState().zobrist_key);
+    ASSERT_TRUE(FenParser::parse_fen(std::string_view("rnbqkbnr/pppp1ppp/8/8/4p3/8/PPPPPPPP/RNBQKBNR w KQkq - 0 1"), game) == FenError::None);
+    ASSERT_TRUE(FenParser::parse_fen(std::string_view("rnbqkbnr/pppp1ppp/8/4p3/4P3/8/PPPP1PPP/RNBQKBNR w KQkq e6 0 2"), game) == FenError::None);
+    // one pawn promoted to a second queen
+    ASSERT_TRUE(FenParser::parse_fen(std::string_view("k7/8/8/8/8/8/PPPPPPP1/QQK5 b - - 0 1"), game) == FenError::None);
+}
+
+// FEN written by to_fen parses back into the same position and the same string
+TEST(FenParserTest, ToFenRoundTrip) {
+    std::vector<std::string> fens = {
+        STARTING_FEN,
+        "r3k2r/p1ppqpb1/bn2pnp1/3PN3/1p2P3/2N2Q1p/PPPBBPPP/R3K2R w KQkq - 0 1",
+        "8/2p5/3p4/KP5r/1R3p1k/8/4P1P1/8 w - - 0 1",
+        "r3k2r/Pppp1ppp/1b3nbN/nP6/BBP1P3/q4N2/Pp1P2PP/R2Q1RK1 w kq - 0 1",
+        "rnbq1k1r/pp1Pbppp/2p5/8/2B5/8/PPP1NnPP/RNBQK2R w KQ - 1 8",
+        "rnbqkbnr/pppp1ppp/8/4p3/4P3/8/PPPP1PPP/RNBQKBNR w KQkq e6 0 2",
+        "4k3/8/8/8/8/8/8/4K2R b K - 99 123",
+    };
+
+    char buffer[Position::MAX_FEN_LENGTH + 1];
+    for (const std::string &fen : fens) {
+        GameState game = FenParser::parse_fen(fen);
+        ASSERT_EQ(game.to_fen(buffer, sizeof(buffer)), fen.size());
+        ASSERT_EQ(std::string(buffer), fen);
+    }
+
+    // the position after a double push has the en passant square
+    GameState game;
+    game.make_move(Move(52, 36, Piece::White | Piece::Pawn, Move::DOUBLE_PUSH));
+    game.to_fen(buffer, sizeof(buffer));
+    ASSERT_EQ(std::string(buffer), "rnbqkbnr/pppppppp/8/8/4P3/8/PPPP1PPP/RNBQKBNR b KQkq e3 0 1");
+}
+
+TEST(FenParserTest, ToEpdAndSmallBuffers) {
+    GameState game;
+    char buffer[128];
+    ASSERT_EQ(game.to_epd(buffer, sizeof(buffer)), std::strlen("rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq -"));
+    ASSERT_EQ(std::string(buffer), "rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq -");
+
+    std::string epd = "rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - bm e4; id \"start\";";
+    ASSERT_EQ(game.to_epd(buffer, sizeof(buffer), "bm e4; id \"start\";"), epd.size());
+    ASSERT_EQ(std::string(buffer), epd);
+
+    // too small buffers are not written to
+    std::string fen = STARTING_FEN;
+    std::memset(buffer, 'x', sizeof(buffer));
+    ASSERT_EQ(game.to_fen(buffer, fen.size()), 0);
+    ASSERT_EQ(game.to_epd(buffer, epd.size(), "bm e4; id \"start\";"), 0);
+    ASSERT_EQ(buffer[0], 'x');
+    ASSERT_EQ(game.to_fen(buffer, fen.size() + 1), fen.size());
+    ASSERT_EQ(std::string(buffer), fen);
+}
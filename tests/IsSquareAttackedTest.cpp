@@ -0,0 +1,48 @@
+#include "../include/GameState.h"
+#include "../include/ChessConstants.h"
+#include "../include/FenParser.h"
+#include "gtest/gtest.h"
+
+TEST(IsSquareAttackedTest, StartingPosition) {
+    GameState game = FenParser::parse_fen(STARTING_FEN);
+    // every square of the 3rd rank is defended by white pawns
+    for(int i = 40; i < 48; i++){
+        ASSERT_TRUE(game.is_square_attacked(i, Piece::Black));
+        ASSERT_FALSE(game.is_square_attacked(i, Piece::White));
+    }
+    // nothing attacks the middle of the board
+    for(int i = 24; i < 40; i++){
+        ASSERT_FALSE(game.is_square_attacked(i, Piece::Black));
+        ASSERT_FALSE(game.is_square_attacked(i, Piece::White));
+    }
+}
+
+TEST(IsSquareAttackedTest, AttackMapMatchesSquareChecks) {
+    std::vector<std::string> fens = {
+        STARTING_FEN,
+        "r3k2r/p1ppqpb1/bn2pnp1/3PN3/1p2P3/2N2Q1p/PPPBBPPP/R3K2R w KQkq - 0 1",
+        "8/2p5/3p4/KP5r/1R3p1k/8/4P1P1/8 w - - 0 1",
+        "r3k2r/Pppp1ppp/1b3nbN/nP6/BBP1P3/q4N2/Pp1P2PP/R2Q1RK1 w kq - 0 1",
+        "r4rk1/1pp1qppp/p1np1n2/2b1p1B1/2B1P1b1/P1NP1N2/1PP1QPPP/R4RK1 w - - 0 10"
+    };
+    for(auto &fen : fens){
+        GameState game = FenParser::parse_fen(fen);
+        u_long64_t white_attacks = game.attacked_squares(Piece::White, game.occupancy());
+        u_long64_t black_attacks = game.attacked_squares(Piece::Black, game.occupancy());
+        for(int i = 0; i < 64; i++){
+            ASSERT_EQ(Bitboard::is_set(white_attacks, i), game.is_square_attacked(i, Piece::Black)) << fen << " " << i;
+            ASSERT_EQ(Bitboard::is_set(black_attacks, i), game.is_square_attacked(i, Piece::White)) << fen << " " << i;
+        }
+    }
+}
+
+TEST(IsSquareAttackedTest, KingCannotRetreatAlongCheck) {
+    // the rook on a8 checks the king on d8, c8 and e8 are attacked
+    // and e8 is only attacked when the king is removed from the board
+    GameState game = FenParser::parse_fen("R2k4/8/3K4/8/8/8/8/8 b - - 0 1");
+    for(auto &move : game.get_legal_moves()){
+        ASSERT_NE(move.end, 2);
+        ASSERT_NE(move.end, 4);
+    }
+    ASSERT_EQ(game.get_legal_moves().size(), 0);
+}
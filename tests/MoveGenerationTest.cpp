@@ -1,9 +1,12 @@
 #include "../include/GameState.h"
 #include "../include/ChessConstants.h"
 #include "../include/FenParser.h"
+#include "../include/Attacks.h"
+#include "../include/StagedMoveGenerator.h"
 #include "gtest/gtest.h"
 #include <fstream>
 #include <sstream>  
+#include <random>
 
 std::vector<Move> moves_from_ulong(int square, u_long64_t bitmask, int piece){
     std::vector<Move> moves;
@@ -15,70 +18,439 @@ std::vector<Move> moves_from_ulong(int square, u_long64_t bitmask, int piece){
     return moves;
 }
 
-TEST(NewGenTest, BishopTest) {
-    GameState game = FenParser::parse_fen(STARTING_FEN);
-    game.board.fill(0);
-    std::string input;
-    // for bishops
+// legal moves of a white piece put on every square next to the kings on a1 and h8, compared with the
+// reference attacks, the enemy king can not be captured and is left out of both
+void expect_moves_match_attacks(int piece, u_long64_t (*attacks)(int, u_long64_t)) {
+    Position position = FenParser::parse_fen("7k/8/8/8/8/8/8/K7 w - - 0 1").position();
+    u_long64_t kings = position.occupancy();
     for(int i = 0; i < 64; i++){
-        game.board[i] = Piece::Bishop | Piece::White;
-        std::vector<Move> moves = game.generate_diagonal_sliding_moves(i);
-        std::for_each(moves.begin(), moves.end(), [](Move &move){
-            move.flags = Move::NORMAL;
-        });
-
-        std::vector<Move> moves2 = moves_from_ulong(i, ChessConstants::bishop_lookup[i], Piece::Bishop | Piece::White);
-        
+        if(position.board[i] != 0){
+            continue;
+        }
+        position.put_piece(i, piece);
+        MoveList move_list;
+        position.generate_legal_moves(position.turn, move_list);
+        std::vector<Move> moves;
+        for(PackedMove packed : move_list){
+            Move move = position.to_move(packed);
+            if(move.start == i && move.end != position.black_king_square){
+                move.flags = Move::NORMAL;
+                moves.push_back(move);
+            }
+        }
+
+        std::vector<Move> moves2 = moves_from_ulong(i, attacks(i, kings) & ~kings, piece);
+
         std::sort(moves.begin(), moves.end());
         std::sort(moves2.begin(), moves2.end());
-        
-        ASSERT_EQ(moves, moves2);
-        
-        game.board[i] = 0;
+
+        ASSERT_EQ(moves, moves2) << i;
+
+        position.remove_piece(i);
     }
 }
+
+TEST(NewGenTest, BishopTest) {
+    expect_moves_match_attacks(Piece::Bishop | Piece::White, Attacks::reference_bishop_attacks);
+}
+
 TEST(NewGenTest, KnightTest) {
-    GameState game = FenParser::parse_fen(STARTING_FEN);
-    game.board.fill(0);
-    std::string input;
-    // for knights
+    expect_moves_match_attacks(Piece::Knight | Piece::White, [](int square, u_long64_t) { return Attacks::knight_attacks(square); });
+}
+
+TEST(NewGenTest, RookTest) {
+    expect_moves_match_attacks(Piece::Rook | Piece::White, Attacks::reference_rook_attacks);
+}
+
+TEST(NewGenTest, QueenTest) {
+    expect_moves_match_attacks(Piece::Queen | Piece::White, [](int square, u_long64_t occupancy) {
+        return Attacks::reference_rook_attacks(square, occupancy) | Attacks::reference_bishop_attacks(square, occupancy);
+    });
+}
+
+void expect_bitboards_in_sync(const GameState &game){
     for(int i = 0; i < 64; i++){
-        game.board[i] = Piece::Knight | Piece::White;
-        std::vector<Move> moves = game.generate_knight_moves(i);
-        std::for_each(moves.begin(), moves.end(), [](Move &move){
-            move.flags = Move::NORMAL;
-        });
+        int piece = game.board[i];
+        for(int type = 1; type < 8; type++){
+            ASSERT_EQ(Bitboard::is_set(game.piece_bitboards[type], i), piece != 0 && Piece::piece_type(piece) == type);
+        }
+        ASSERT_EQ(Bitboard::is_set(game.colour_bitboards[0], i), Piece::colour(piece) == Piece::White);
+        ASSERT_EQ(Bitboard::is_set(game.colour_bitboards[1], i), Piece::colour(piece) == Piece::Black);
+    }
+}
 
-        std::vector<Move> moves2 = moves_from_ulong(i, ChessConstants::knight_lookup[i], Piece::Knight | Piece::White);
+TEST(BitboardTest, InSyncAfterMakeAndUndo) {
+    // position with castles, en passant and promotions available
+    GameState game = FenParser::parse_fen("r3k2r/Pppp1ppp/1b3nbN/nP6/BBP1P3/q4N2/Pp1P2PP/R2Q1RK1 w kq - 0 1");
+    expect_bitboards_in_sync(game);
+    for(auto &move : game.get_legal_moves()){
+        game.make_move(move);
+        expect_bitboards_in_sync(game);
+        for(auto &reply : game.get_legal_moves()){
+            game.make_move(reply);
+            expect_bitboards_in_sync(game);
+            game.undo_move();
+        }
+        game.undo_move();
+        expect_bitboards_in_sync(game);
+    }
+}
 
-        std::sort(moves.begin(), moves.end());
-        std::sort(moves2.begin(), moves2.end());
-        
-        ASSERT_EQ(moves, moves2);
-        
-        game.board[i] = 0;
+TEST(MagicTest, MatchesRayWalking) {
+    std::mt19937_64 rng(42);
+    for(int i = 0; i < 64; i++){
+        // the exported rays add up to the empty board attacks
+        ASSERT_EQ(Attacks::ray(0, i) | Attacks::ray(1, i) | Attacks::ray(2, i) | Attacks::ray(3, i), Attacks::reference_rook_attacks(i, 0));
+        ASSERT_EQ(Attacks::ray(4, i) | Attacks::ray(5, i) | Attacks::ray(6, i) | Attacks::ray(7, i), Attacks::reference_bishop_attacks(i, 0));
+        for(int j = 0; j < 1000; j++){
+            // sparse random occupancies, like in a real game
+            u_long64_t occupancy = rng() & rng();
+            ASSERT_EQ(Attacks::rook_attacks(i, occupancy), Attacks::reference_rook_attacks(i, occupancy));
+            ASSERT_EQ(Attacks::bishop_attacks(i, occupancy), Attacks::reference_bishop_attacks(i, occupancy));
+        }
     }
 }
 
-TEST(NewGenTest, RookTest) {
-    GameState game = FenParser::parse_fen(STARTING_FEN);
-    game.board.fill(0);
-    std::string input;
-    // for rooks
+TEST(MagicTest, PextMatchesMagic) {
+    if(!Attacks::cpu_has_pext()){
+        GTEST_SKIP() << "CPU without BMI2";
+    }
+
+    std::mt19937_64 rng(42);
     for(int i = 0; i < 64; i++){
-        game.board[i] = Piece::Rook | Piece::White;
-        std::vector<Move> moves = game.generate_straight_sliding_moves(i);
-        std::for_each(moves.begin(), moves.end(), [](Move &move){
-            move.flags = Move::NORMAL;
-        });
+        for(int j = 0; j < 1000; j++){
+            u_long64_t occupancy = rng() & rng();
+            ASSERT_EQ(Attacks::rook_attacks<Attacks::SliderBackend::Pext>(i, occupancy), Attacks::reference_rook_attacks(i, occupancy));
+            ASSERT_EQ(Attacks::bishop_attacks<Attacks::SliderBackend::Pext>(i, occupancy), Attacks::reference_bishop_attacks(i, occupancy));
+        }
+    }
+}
 
-        std::vector<Move> moves2 = moves_from_ulong(i, ChessConstants::rook_lookup[i], Piece::Rook | Piece::White);
+TEST(MagicTest, PextGeneratorsMatchMagic) {
+    Attacks::SliderBackend startup_backend = Position::get_slider_backend();
+    if(!Position::set_slider_backend(Attacks::SliderBackend::Pext)){
+        GTEST_SKIP() << "CPU without BMI2";
+    }
 
-        std::sort(moves.begin(), moves.end());
-        std::sort(moves2.begin(), moves2.end());
-        
-        ASSERT_EQ(moves, moves2);
-        
-        game.board[i] = 0;
+    // the startup backend is PEXT only on CPUs where it is fast
+    ASSERT_EQ(startup_backend == Attacks::SliderBackend::Pext, Attacks::cpu_has_fast_pext());
+
+    GameState game = FenParser::parse_fen("r3k2r/p1ppqpb1/bn2pnp1/3PN3/1p2P3/2N2Q1p/PPPBBPPP/R3K2R w KQkq - 0 1");
+    Position child;
+    for(PackedMove move : game.get_legal_move_list()){
+        game.make_move(move, child);
+        MoveList pext_moves;
+        child.generate_legal_moves(child.turn, pext_moves);
+        int pext_count = child.count_legal_moves();
+        u_long64_t pext_pinned = child.pinned_pieces(child.turn);
+
+        Position::set_slider_backend(Attacks::SliderBackend::Magic);
+        MoveList magic_moves;
+        child.generate_legal_moves(child.turn, magic_moves);
+        ASSERT_EQ(pext_moves.size(), magic_moves.size());
+        for(int i = 0; i < magic_moves.size(); i++){
+            ASSERT_TRUE(pext_moves[i] == magic_moves[i]);
+        }
+        ASSERT_EQ(pext_count, child.count_legal_moves());
+        ASSERT_EQ(pext_pinned, child.pinned_pieces(child.turn));
+        Position::set_slider_backend(Attacks::SliderBackend::Pext);
+    }
+
+    Position::set_slider_backend(startup_backend);
+}
+
+TEST(PackedMoveTest, RoundTrip) {
+    static_assert(sizeof(PackedMove) == 2, "PackedMove should fit in 16 bits");
+    // castles, en passant and (capture) promotions are all legal in these positions
+    std::vector<std::string> fens = {
+        "r3k2r/Pppp1ppp/1b3nbN/nP6/BBP1P3/q4N2/Pp1P2PP/R2Q1RK1 w kq - 0 1",
+        "r3k2r/p1ppqpb1/bn2pnp1/3PN3/1p2P3/2N2Q1p/PPPBBPPP/R3K2R w KQkq - 0 1",
+        "r3k2r/p1ppqpb1/bn2pnp1/3PN3/Pp2P3/2N2Q1p/1PPBBPPP/R3K2R b KQkq a3 0 1",
+        "n1n5/PPPk4/8/8/8/8/4Kppp/5N1N b - - 0 1"
+    };
+    for(auto &fen : fens){
+        GameState game = FenParser::parse_fen(fen);
+        for(auto &move : game.get_legal_moves()){
+            PackedMove packed(move);
+            ASSERT_EQ(packed.to_move(move.piece), move);
+            ASSERT_EQ(packed.perft_str(), move.perft_str());
+            ASSERT_EQ(packed.lan_str(move.piece), move.lan_str());
+        }
+    }
+}
+
+TEST(LegalMoveTest, EnPassantDiscoveredCheck) {
+    // b5xc6 e.p would remove both pawns from the 5th rank and expose the king to the rook
+    GameState game = FenParser::parse_fen("8/8/8/KPp4r/8/8/8/7k w - c6 0 2");
+    for(auto &move : game.get_legal_moves()){
+        ASSERT_FALSE(Move::is_en_passant(move.flags));
+    }
+
+    // without the rook the capture is legal
+    game = FenParser::parse_fen("8/8/8/KPp5/8/8/8/7k w - c6 0 2");
+    std::vector<Move> moves = game.get_legal_moves();
+    ASSERT_TRUE(std::find(moves.begin(), moves.end(), Move(25, 18, Piece::Pawn | Piece::White, Move::EN_PASSANT)) != moves.end());
+}
+
+TEST(LegalMoveTest, PinnedPiecesMoveAlongThePin) {
+    // the rook on e4 is pinned by the rook on e8, the knight on d2 by the bishop on a5
+    GameState game = FenParser::parse_fen("4r2k/8/8/b7/4R3/8/3N4/4K3 w - - 0 1");
+    for(auto &move : game.get_legal_moves()){
+        if(move.start == 36){
+            ASSERT_EQ(game.get_file(move.end), 5);
+        }
+        ASSERT_NE(move.start, 51);
+    }
+}
+
+void expect_incremental_key(GameState &game, int depth){
+    ASSERT_EQ(game.zobrist_key, game.compute_zobrist_key());
+    if(depth == 0){
+        return;
+    }
+    MoveList moves = game.get_legal_move_list();
+    for(auto &move : moves){
+        u_long64_t key_before = game.zobrist_key;
+        game.make_move_unchecked(move);
+        ASSERT_NE(game.zobrist_key, key_before);
+        expect_incremental_key(game, depth - 1);
+        game.undo_move();
+        ASSERT_EQ(game.zobrist_key, key_before);
+    }
+}
+
+TEST(ZobristTest, IncrementalKeyMatchesFullKey) {
+    // castles, en passant and promotions are covered by these positions
+    GameState game = FenParser::parse_fen("r3k2r/p1ppqpb1/bn2pnp1/3PN3/1p2P3/2N2Q1p/PPPBBPPP/R3K2R w KQkq - 0 1");
+    expect_incremental_key(game, 3);
+    game = FenParser::parse_fen("r3k2r/Pppp1ppp/1b3nbN/nP6/BBP1P3/q4N2/Pp1P2PP/R2Q1RK1 w kq - 0 1");
+    expect_incremental_key(game, 3);
+}
+
+TEST(ZobristTest, TranspositionsHaveEqualKeys) {
+    GameState game1 = FenParser::parse_fen(STARTING_FEN);
+    GameState game2 = FenParser::parse_fen(STARTING_FEN);
+    game1.make_move("Ng1-f3");
+    game1.make_move("Ng8-f6");
+    game1.make_move("Nb1-c3");
+    game2.make_move("Nb1-c3");
+    game2.make_move("Ng8-f6");
+    game2.make_move("Ng1-f3");
+    ASSERT_EQ(game1.zobrist_key, game2.zobrist_key);
+    // different side to move
+    game1.make_move("Nf6-g8");
+    ASSERT_NE(game1.zobrist_key, game2.zobrist_key);
+}
+
+void expect_same_position(const Position &a, const Position &b) {
+    ASSERT_EQ(a.board, b.board);
+    ASSERT_EQ(a.piece_bitboards, b.piece_bitboards);
+    ASSERT_EQ(a.colour_bitboards, b.colour_bitboards);
+    ASSERT_EQ(a.turn, b.turn);
+    ASSERT_EQ(a.castling_rights, b.castling_rights);
+    ASSERT_EQ(a.en_passant_target, b.en_passant_target);
+    ASSERT_EQ(a.white_king_square, b.white_king_square);
+    ASSERT_EQ(a.black_king_square, b.black_king_square);
+    ASSERT_EQ(a.halfmove_clock, b.halfmove_clock);
+    ASSERT_EQ(a.fullmove_counter, b.fullmove_counter);
+    ASSERT_EQ(a.zobrist_key, b.zobrist_key);
+}
+
+TEST(PositionTest, CopyMakeMatchesMakeMove) {
+    GameState game = FenParser::parse_fen("r3k2r/Pppp1ppp/1b3nbN/nP6/BBP1P3/q4N2/Pp1P2PP/R2Q1RK1 w kq - 0 1");
+    GameState parent = game;
+    MoveList moves = game.get_legal_move_list();
+    Position child;
+    for(PackedMove move : moves) {
+        game.make_move(move, child);
+        expect_same_position(game.position(), parent.position());
+
+        game.make_move_unchecked(move);
+        expect_same_position(child, game.position());
+        game.undo_move();
+    }
+}
+
+// the Position of a GameState only changes through make_move, undo_move and set_position,
+// otherwise the cached legal moves would belong to another position
+static_assert(!std::is_convertible<GameState &, Position &>::value, "GameState can not be changed as a Position");
+
+TEST(StagedMoveGeneratorTest, TacticalMovesComeFirst) {
+    const std::string fens[] = {
+        "r3k2r/p1ppqpb1/bn2pnp1/3PN3/1p2P3/2N2Q1p/PPPBBPPP/R3K2R w KQkq - 0 1",
+        "r3k2r/Pppp1ppp/1b3nbN/nP6/BBP1P3/q4N2/Pp1P2PP/R2Q1RK1 w kq - 0 1",
+        "n1n5/PPPk4/8/8/8/8/4Kppp/5N1N b - - 0 1",
+        // en passant
+        "rnbqkbnr/ppp1p1pp/8/3pPp2/8/8/PPPP1PPP/RNBQKBNR w KQkq f6 0 3",
+    };
+    for(const std::string &fen : fens) {
+        GameState game = FenParser::parse_fen(fen);
+        const MoveList &all = game.get_legal_move_list();
+
+        StagedMoveGenerator generator(game.position());
+        PackedMove move;
+        int count = 0;
+        bool quiet_seen = false;
+        while(generator.next(move)) {
+            count++;
+            ASSERT_TRUE(all.contains(move));
+            bool tactical = move.is_capture() || move.is_en_passant() || move.is_promotion();
+            ASSERT_EQ(tactical, generator.stage() == StagedMoveGenerator::Stage::Tactical);
+            // once the quiet moves started no tactical move may follow
+            ASSERT_FALSE(tactical && quiet_seen);
+            quiet_seen = !tactical;
+        }
+        ASSERT_EQ(count, all.size());
+        ASSERT_EQ(generator.stage(), StagedMoveGenerator::Stage::Done);
+    }
+}
+
+TEST(CapturesTest, OnlyCapturesAndQueenPromotions) {
+    const std::string fens[] = {
+        "r3k2r/p1ppqpb1/bn2pnp1/3PN3/1p2P3/2N2Q1p/PPPBBPPP/R3K2R w KQkq - 0 1",
+        "r3k2r/Pppp1ppp/1b3nbN/nP6/BBP1P3/q4N2/Pp1P2PP/R2Q1RK1 w kq - 0 1",
+        "n1n5/PPPk4/8/8/8/8/4Kppp/5N1N b - - 0 1",
+        "rnbqkbnr/ppp1p1pp/8/3pPp2/8/8/PPPP1PPP/RNBQKBNR w KQkq f6 0 3",
+    };
+    for(const std::string &fen : fens) {
+        GameState game = FenParser::parse_fen(fen);
+        MoveList captures;
+        game.generate_captures(captures);
+
+        int expected = 0;
+        for(PackedMove move : game.get_legal_move_list()) {
+            bool is_queen_promotion = move.is_promotion() && move.promotion_piece() == Piece::Queen;
+            bool is_underpromotion = move.is_promotion() && !is_queen_promotion;
+            if(is_queen_promotion || (!is_underpromotion && (move.is_capture() || move.is_en_passant()))) {
+                expected++;
+                ASSERT_TRUE(captures.contains(move));
+            }
+        }
+        ASSERT_EQ(captures.size(), expected);
+    }
+}
+
+// in check generate_legal_moves uses the evasion generator, the tactical and quiet moves
+// are still generated with the check mask, so both ways have to give the same moves
+void expect_evasions_match(GameState &game, int depth) {
+    int king_square = game.turn == Piece::White ? game.white_king_square : game.black_king_square;
+    if(game.is_square_attacked(king_square, game.turn)) {
+        MoveList evasions;
+        game.generate_legal_moves(game.turn, evasions);
+        MoveList masked;
+        game.generate_legal_moves(game.turn, masked, GenType::Tactical);
+        game.generate_legal_moves(game.turn, masked, GenType::Quiet);
+        ASSERT_EQ(evasions.size(), masked.size());
+        for(PackedMove move : masked) {
+            ASSERT_TRUE(evasions.contains(move));
+        }
+    }
+    if(depth == 0) {
+        return;
     }
-};
\ No newline at end of file
+    MoveList moves = game.get_legal_move_list();
+    for(PackedMove move : moves) {
+        game.make_move_unchecked(move);
+        expect_evasions_match(game, depth - 1);
+        game.undo_move();
+    }
+}
+
+TEST(EvasionTest, MatchesCheckMaskGeneration) {
+    const std::string fens[] = {
+        "r3k2r/p1ppqpb1/bn2pnp1/3PN3/1p2P3/2N2Q1p/PPPBBPPP/R3K2R w KQkq - 0 1",
+        "r3k2r/Pppp1ppp/1b3nbN/nP6/BBP1P3/q4N2/Pp1P2PP/R2Q1RK1 w kq - 0 1",
+        "8/2p5/3p4/KP5r/1R3p1k/8/4P1P1/8 w - - 0 1",
+        "rnbq1k1r/pp1Pbppp/2p5/8/2B5/8/PPP1NnPP/RNBQK2R w KQ - 1 8",
+    };
+    for(const std::string &fen : fens) {
+        GameState game = FenParser::parse_fen(fen);
+        expect_evasions_match(game, 3);
+    }
+}
+
+TEST(EvasionTest, BlocksAndEnPassant) {
+    // check along the back rank, Kb2 or the bishop blocks on g1, no pawn may push to the first rank
+    GameState game = FenParser::parse_fen("4k3/8/8/8/8/8/P6B/K6r w - - 0 1");
+    ASSERT_EQ(game.get_legal_move_list().size(), 2);
+    ASSERT_TRUE(game.get_legal_move_list().contains(PackedMove(Move(55, 62, Piece::White | Piece::Bishop, Move::NORMAL))));
+
+    // the pawn that just moved gives check and can be captured en passant
+    game = FenParser::parse_fen("8/8/8/2k5/3Pp3/8/8/4K3 b - d3 0 1");
+    ASSERT_TRUE(game.get_legal_move_list().contains(PackedMove(Move(36, 43, Piece::Black | Piece::Pawn, Move::EN_PASSANT))));
+    ASSERT_TRUE(game.get_legal_move_list().contains(PackedMove(Move(26, 35, Piece::Black | Piece::King, Move::CAPTURE))));
+}
+
+std::string uci_str(const Move &move) {
+    std::string uci = {(char)('a' + move.start % 8), (char)('8' - move.start / 8), (char)('a' + move.end % 8), (char)('8' - move.end / 8)};
+    if(Move::is_promotion_queen(move.flags)) uci += 'q';
+    if(Move::is_promotion_rook(move.flags)) uci += 'r';
+    if(Move::is_promotion_bishop(move.flags)) uci += 'b';
+    if(Move::is_promotion_knight(move.flags)) uci += 'n';
+    return uci;
+}
+
+// every legal move is found from its coordinates with the same flags, and making it by uci gives the same position
+void expect_uci_moves_match(GameState &game, int depth) {
+    MoveList moves = game.get_legal_move_list();
+    for(PackedMove packed : moves) {
+        Move move = game.to_move(packed);
+        int start, end, promotion;
+        Move found;
+        ASSERT_TRUE(Move::parse_uci(uci_str(move), start, end, promotion));
+        ASSERT_TRUE(game.find_legal_move(start, end, promotion, found)) << uci_str(move);
+        ASSERT_EQ(found, move);
+
+        if(depth > 1) {
+            u_long64_t key = game.zobrist_key;
+            ASSERT_TRUE(game.make_move_uci(uci_str(move)));
+            expect_uci_moves_match(game, depth - 1);
+            game.undo_move();
+            ASSERT_EQ(game.zobrist_key, key);
+        }
+    }
+}
+
+TEST(UciMoveTest, FindsEveryLegalMove) {
+    const std::string fens[] = {
+        STARTING_FEN,
+        "r3k2r/p1ppqpb1/bn2pnp1/3PN3/1p2P3/2N2Q1p/PPPBBPPP/R3K2R w KQkq - 0 1",
+        "r3k2r/Pppp1ppp/1b3nbN/nP6/BBP1P3/q4N2/Pp1P2PP/R2Q1RK1 w kq - 0 1",
+        "8/2p5/3p4/KP5r/1R3p1k/8/4P1P1/8 w - - 0 1",
+        "rnbq1k1r/pp1Pbppp/2p5/8/2B5/8/PPP1NnPP/RNBQK2R w KQ - 1 8",
+    };
+    for(const std::string &fen : fens) {
+        GameState game = FenParser::parse_fen(fen);
+        expect_uci_moves_match(game, 3);
+    }
+}
+
+TEST(UciMoveTest, RejectsInvalidMoves) {
+    GameState game = FenParser::parse_fen("r3k2r/Pppp1ppp/1b3nbN/nP6/BBP1P3/q4N2/Pp1P2PP/R2Q1RK1 w kq - 0 1");
+    u_long64_t key = game.zobrist_key;
+    const std::string invalid[] = {
+        "", "e2", "e2e4 ", "i2i4", "a0a1", "e2e4x", "b7b8", "b7b8k", "a7a8q", "g1g2q", "f1f1", "e1g1", "0000", "c4d5",
+    };
+    for(const std::string &move : invalid) {
+        ASSERT_FALSE(game.make_move_uci(move)) << move;
+        ASSERT_EQ(game.zobrist_key, key);
+    }
+    ASSERT_THROW(game.make_move(Move(60, 62, Piece::White | Piece::King, Move::CASTLE_KINGSIDE)), std::invalid_argument);
+
+    game = FenParser::parse_fen("r3k2r/1P6/8/8/8/8/8/4K3 w kq - 0 1");
+    ASSERT_FALSE(game.make_move_uci("b7a8"));
+    ASSERT_TRUE(game.make_move_uci("b7a8n"));
+    ASSERT_TRUE(game.board[0] == (Piece::White | Piece::Knight));
+    ASSERT_TRUE(game.make_move_uci("e8g8"));
+    ASSERT_TRUE(game.board[6] == (Piece::Black | Piece::King));
+}
+
+TEST(MoveTest, UncheckedConstructionIsConstexpr) {
+    constexpr Move move(Move::UNCHECKED, 52, 36, Piece::White | Piece::Pawn, Move::DOUBLE_PUSH);
+    static_assert(Move::is_double_push(move.flags) && !Move::is_capture(move.flags), "flags are checked at compile time");
+    ASSERT_EQ(move, Move(52, 36, Piece::White | Piece::Pawn, Move::DOUBLE_PUSH));
+
+    // the checked constructor still validates moves from outside
+    ASSERT_THROW(Move(52, 64, Piece::White | Piece::Pawn), std::invalid_argument);
+    ASSERT_THROW(Move(-1, 36, Piece::White | Piece::Pawn), std::invalid_argument);
+}